@@ -24,6 +24,31 @@ namespace nanodb {
         // Size of candidate list during insertion (Higher = better quality, slower build)
         constexpr int EF_CONSTRUCTION = 200; 
 
+
+        // IVF Algorithm Hyperparameters
+        // Number of inverted lists (k-means centroids). Rule of thumb: ~sqrt(N).
+        constexpr size_t IVF_NLIST = 256;
+
+        // Lists scanned per query (Higher = better recall, slower search)
+        constexpr int IVF_NPROBE = 8;
+
+        // Lloyd iterations during training (Converges quickly on embeddings)
+        constexpr int IVF_KMEANS_ITERS = 10;
+
+        // Training sample cap per centroid (Keeps training cost independent of N)
+        constexpr size_t IVF_TRAIN_SAMPLES_PER_LIST = 256;
+
+        
+        // Tiered Mode (Graph + SQ8 codes in RAM, full vectors on SSD)
+        // Approximate candidates re-ranked with exact vectors read from disk
+        constexpr size_t TIERED_RERANK = 64;
+
+        // Logical block size for O_DIRECT reads (offsets, lengths and buffers aligned to it)
+        constexpr size_t DIRECT_IO_ALIGNMENT = 512;
+
+        // Max reads in flight per async reader
+        constexpr unsigned ASYNC_QUEUE_DEPTH = 128;
+
         
         // System Settings
         constexpr char DB_FILE_PATH[] = "data/index.ndb";
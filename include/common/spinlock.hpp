@@ -1,5 +1,6 @@
 #pragma once
 #include <atomic>
+#include <cstddef>
 
 namespace nanodb {
 
@@ -7,10 +8,13 @@ namespace nanodb {
     // Much faster than std::mutex for small, quick updates like ours.
     class SpinLock {
     public:
-        void lock() {
+        // Returns the number of spin iterations (0 = uncontended), used for contention stats.
+        size_t lock() {
+            size_t spins = 0;
             // "flag" is false (unlocked). We try to set it to true (locked).
             // memory_order_acquire ensures we see latest data.
             while (flag.test_and_set(std::memory_order_acquire)) {
+                spins++;
                 // Spin-wait (CPU hint to pause slightly)
                 #if defined(_MSC_VER)
                     _mm_pause(); 
@@ -18,6 +22,7 @@ namespace nanodb {
                     __builtin_ia32_pause();
                 #endif
             }
+            return spins;
         }
 
         void unlock() {
@@ -16,9 +16,18 @@ namespace nanodb {
         id_t id;
         float distance;
         std::string metadata; // <--- NEW FIELD
+        bool early_terminated = false; // Query stopped on a SearchParams limit
 
         bool operator>(const Result& other) const { return distance > other.distance; }
         bool operator<(const Result& other) const { return distance < other.distance; }
     };
 
+    // Per-query search knobs. A zero limit is disabled; the defaults reproduce plain search().
+    struct SearchParams {
+        int ef = 100;                           // Beam width at layer 0 (raised to k if smaller)
+        int patience = 0;                       // Stop after N expansions that leave the top-k unchanged
+        size_t max_distance_computations = 0;   // Per-query distance budget
+        uint64_t timeout_us = 0;                // Per-query deadline, measured from search() entry
+    };
+
 } // namespace nanodb
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 namespace nanodb {
 
@@ -9,4 +10,8 @@ namespace nanodb {
     // Note: We skip sqrt() for performance since it preserves ranking order.
     float get_distance(const float* a, const float* b, size_t dim);
 
+    // Squared L2 between a float query and an 8-bit scalar-quantized vector.
+    // Each code decodes as: value = vmin[i] + code[i] * vscale[i] (decoded on the fly in AVX2 registers).
+    float get_distance_sq8(const float* query, const uint8_t* code, const float* vmin, const float* vscale, size_t dim);
+
 } // namespace nanodb
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "../storage/mmap_handler.hpp"
 #include "../common/spinlock.hpp"
 #include "../storage/metadata_handler.hpp" // <--- Handler
+#include "stats.hpp"
 #include <queue>
 #include <vector>
 #include <random>
@@ -14,6 +15,9 @@
 #include <omp.h>
 #include <mutex>
 #include <memory>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
 
 namespace nanodb {
 
@@ -30,19 +34,14 @@ namespace nanodb {
             std::random_device rd;
             rng_.seed(rd());
             
-            size_t current_count = 0;
+            // Locks cover every slot the file can already hold
+            size_t current_count = storage_.get_size() / sizeof(Node);
 
-            if (storage_.get_size() == 0) {
-                entry_point_id_ = -1;
-                current_max_layer_ = -1;
-                element_count_ = 0;
-                current_count = 0;
-            } else {
-                entry_point_id_ = 0; 
-                current_max_layer_ = 0; 
-                element_count_ = storage_.get_size() / sizeof(Node);
-                current_count = element_count_;
-            }
+            entry_point_id_ = -1;
+            current_max_layer_ = -1;
+            element_count_ = 0;
+            entry_path_ = storage_.get_path() + ".entry";
+            if (current_count > 0) recover_graph_state(current_count);
 
             node_locks_.reserve(current_count + 10000);
             for (size_t i = 0; i < current_count + 10000; ++i) {
@@ -54,9 +53,18 @@ namespace nanodb {
 
         // NEW: Accepts metadata string
         void insert(const std::vector<float>& vec_data, id_t id, const std::string& metadata = "") {
+            insert(vec_data.data(), vec_data.size(), id, metadata);
+        }
+
+        // Raw buffer variant: reads `dim` floats in place (no intermediate std::vector).
+        void insert(const float* vec_data, size_t dim, id_t id, const std::string& metadata = "") {
+            const bool track = stats_.enabled();
+            IndexStats::Clock::time_point start_time = track ? IndexStats::Clock::now() : IndexStats::Clock::time_point{};
+            WorkCounters work;
+
             // 1. Assign random level
             int level = get_random_level();
-            Node new_node(id, level, vec_data);
+            Node new_node(id, level, vec_data, dim);
 
             // 2. Expand storage
             size_t offset = (size_t)id * sizeof(Node);
@@ -64,6 +72,7 @@ namespace nanodb {
                 std::lock_guard<std::mutex> lock(global_resize_lock_); 
                 if (offset + sizeof(Node) > storage_.get_size()) {
                     storage_.resize(storage_.get_size() + 10 * 1024 * 1024);
+                    if (track) stats_.record_resize();
                     if (id >= node_locks_.size()) {
                         size_t target_size = id + 10000;
                         node_locks_.reserve(target_size);
@@ -74,9 +83,13 @@ namespace nanodb {
                 }
             }
 
-            // 3. Write node
+            // 3. Write node, then raise the high-water mark before it becomes reachable
             Node* node_ptr = get_node(id);
             *node_ptr = new_node;
+            if ((size_t)id >= element_count_) {
+                std::lock_guard<std::mutex> lock(count_lock_);
+                if ((size_t)id >= element_count_) element_count_ = (size_t)id + 1;
+            }
 
             // 4. Handle first element
             if (entry_point_id_ == -1) {
@@ -84,11 +97,11 @@ namespace nanodb {
                 if (entry_point_id_ == -1) {
                     entry_point_id_ = id;
                     current_max_layer_ = level;
-                    #pragma omp atomic
-                    element_count_++;
-                    
+                    persist_entry_point();
+
                     // Save metadata for Genesis node
                     if (!metadata.empty()) metadata_storage_.save_metadata(id, metadata);
+                    if (track) stats_.record_insert(work, IndexStats::elapsed_ns(start_time));
                     return; 
                 }
             }
@@ -96,6 +109,7 @@ namespace nanodb {
             // 5. Greedy Search
             id_t curr_obj = entry_point_id_;
             float dist = get_distance(node_ptr->vector, get_node(curr_obj)->vector, config::VECTOR_DIM);
+            work.distance_computations++;
 
             for (int l = current_max_layer_; l > level; l--) {
                 bool changed = true;
@@ -105,14 +119,15 @@ namespace nanodb {
                     for (int i = 0; i < curr_node->neighbor_counts[l]; i++) {
                         id_t n_id = curr_node->neighbors[l][i];
                         float d = get_distance(node_ptr->vector, get_node(n_id)->vector, config::VECTOR_DIM);
-                        if (d < dist) { dist = d; curr_obj = n_id; changed = true; }
+                        work.distance_computations++;
+                        if (d < dist) { dist = d; curr_obj = n_id; changed = true; work.hops++; }
                     }
                 }
             }
 
             // 6. Connect Neighbors
             for (int l = std::min(level, current_max_layer_); l >= 0; l--) {
-                std::priority_queue<Result> candidates = search_layer(curr_obj, node_ptr->vector, config::EF_CONSTRUCTION, l);
+                std::priority_queue<Result> candidates = search_layer(curr_obj, node_ptr->vector, config::EF_CONSTRUCTION, l, work);
                 
                 std::vector<id_t> selected_neighbors;
                 while (!candidates.empty() && selected_neighbors.size() < (size_t)config::M) {
@@ -121,8 +136,8 @@ namespace nanodb {
                 }
 
                 for (id_t neighbor_id : selected_neighbors) {
-                    add_link(id, neighbor_id, l);
-                    add_link(neighbor_id, id, l);
+                    add_link(id, neighbor_id, l, work);
+                    add_link(neighbor_id, id, l, work);
                 }
                 
                 if (!selected_neighbors.empty()) curr_obj = selected_neighbors[0];
@@ -131,74 +146,359 @@ namespace nanodb {
             if (level > current_max_layer_) {
                 entry_point_id_ = id;
                 current_max_layer_ = level;
+                persist_entry_point();
             }
-            
-            #pragma omp atomic
-            element_count_++; 
 
             // --- SAVE METADATA ---
             if (!metadata.empty()) {
                 metadata_storage_.save_metadata(id, metadata);
             }
+
+            if (track) stats_.record_insert(work, IndexStats::elapsed_ns(start_time));
         }
 
         std::vector<Result> search(const std::vector<float>& query, int k) {
-            if (entry_point_id_ == -1) return {};
+            return search(query.data(), k);
+        }
 
-            id_t curr_obj = entry_point_id_;
-            float dist = get_distance(query.data(), get_node(curr_obj)->vector, config::VECTOR_DIM);
+        // Raw-pointer variant. load_metadata = false returns ids + distances only.
+        std::vector<Result> search(const float* query, int k, bool load_metadata = true) {
+            return search(query, k, SearchParams{}, load_metadata);
+        }
 
-            for (int l = current_max_layer_; l > 0; l--) {
-                bool changed = true;
-                while (changed) {
-                    changed = false;
-                    Node* curr_node = get_node(curr_obj);
-                    for (int i = 0; i < curr_node->neighbor_counts[l]; i++) {
-                        id_t n_id = curr_node->neighbors[l][i];
-                        float d = get_distance(query.data(), get_node(n_id)->vector, config::VECTOR_DIM);
-                        if (d < dist) { dist = d; curr_obj = n_id; changed = true; }
-                    }
-                }
-            }
+        std::vector<Result> search(const std::vector<float>& query, int k, const SearchParams& params) {
+            return search(query.data(), k, params);
+        }
+
+        // Adaptive variant: stops the layer-0 walk early on patience, distance budget or
+        // deadline (see SearchParams). Every returned Result carries early_terminated.
+        std::vector<Result> search(const float* query, int k, const SearchParams& params, bool load_metadata = true) {
+            if (entry_point_id_ == -1 || k <= 0) return {};
+
+            const bool track = stats_.enabled();
+            const bool adaptive = params.patience > 0 || params.max_distance_computations > 0 || params.timeout_us > 0;
+            IndexStats::Clock::time_point start_time = (track || adaptive) ? IndexStats::Clock::now() : IndexStats::Clock::time_point{};
+            WorkCounters work;
+
+            id_t curr_obj = greedy_descent(query, 0, work);
 
-            int ef_search = std::max(100, k);
-            std::priority_queue<Result> top_candidates = search_layer(curr_obj, query.data(), ef_search, 0);
+            int ef_search = std::max(params.ef, k);
+            EarlyStop early(params, k, start_time);
+            std::priority_queue<Result> top_candidates = search_layer(curr_obj, query, ef_search, 0, work, adaptive ? &early : nullptr);
 
             std::vector<Result> results;
             while (!top_candidates.empty()) {
-                Result r = top_candidates.top();
-                // --- LOAD METADATA ---
-                r.metadata = metadata_storage_.get_metadata(r.id);
-                results.push_back(r);
+                results.push_back(top_candidates.top());
                 top_candidates.pop();
             }
             std::reverse(results.begin(), results.end());
             if (results.size() > (size_t)k) results.resize(k);
+            if (early.triggered) {
+                for (Result& r : results) r.early_terminated = true;
+            }
+
+            // --- LOAD METADATA --- (Only for the final top-k)
+            if (load_metadata) {
+                for (Result& r : results) {
+                    if (track) {
+                        IndexStats::Clock::time_point meta_start = IndexStats::Clock::now();
+                        r.metadata = metadata_storage_.get_metadata(r.id);
+                        stats_.record_metadata_read(IndexStats::elapsed_ns(meta_start));
+                    } else {
+                        r.metadata = metadata_storage_.get_metadata(r.id);
+                    }
+                }
+            }
 
+            if (track) stats_.record_search(work, IndexStats::elapsed_ns(start_time));
             return results;
         }
 
+        // Batch search over `n` row-major queries (n * VECTOR_DIM floats), parallel across queries.
+        std::vector<std::vector<Result>> search_batch(const float* queries, size_t n, int k, bool load_metadata = true) {
+            return search_batch(queries, n, k, SearchParams{}, load_metadata);
+        }
+
+        std::vector<std::vector<Result>> search_batch(const float* queries, size_t n, int k, const SearchParams& params,
+                                                      bool load_metadata = true) {
+            std::vector<std::vector<Result>> results(n);
+
+            #pragma omp parallel for schedule(dynamic, 4)
+            for (long long i = 0; i < (long long)n; ++i) {
+                results[i] = search(queries + i * config::VECTOR_DIM, k, params, load_metadata);
+            }
+            return results;
+        }
+
+        std::vector<std::vector<Result>> search_batch(const std::vector<std::vector<float>>& queries, int k) {
+            std::vector<std::vector<Result>> results(queries.size());
+
+            #pragma omp parallel for schedule(dynamic, 4)
+            for (long long i = 0; i < (long long)queries.size(); ++i) {
+                results[i] = search(queries[i].data(), k);
+            }
+            return results;
+        }
+
+        // --- Range Search ---
+        // Every vector with distance <= radius (squared L2, same unit as Result::distance),
+        // closest first, capped at the max_results closest. One traversal: the layer-0 walk keeps
+        // expanding while the frontier is still inside the radius.
+        std::vector<Result> range_search(const std::vector<float>& query, float radius, size_t max_results = 1000) {
+            return range_search(query.data(), radius, max_results);
+        }
+
+        std::vector<Result> range_search(const float* query, float radius, size_t max_results, bool load_metadata = true) {
+            if (entry_point_id_ == -1 || max_results == 0) return {};
+
+            const bool track = stats_.enabled();
+            IndexStats::Clock::time_point start_time = track ? IndexStats::Clock::now() : IndexStats::Clock::time_point{};
+            WorkCounters work;
+
+            id_t curr_obj = greedy_descent(query, 0, work);
+            std::vector<Result> results = search_layer_range(curr_obj, query, radius, 100, max_results, work);
+
+            std::sort(results.begin(), results.end());
+            if (results.size() > max_results) results.resize(max_results);
+
+            if (load_metadata) {
+                for (Result& r : results) r.metadata = metadata_storage_.get_metadata(r.id);
+            }
+
+            if (track) stats_.record_search(work, IndexStats::elapsed_ns(start_time));
+            return results;
+        }
+
+        std::vector<std::vector<Result>> range_search_batch(const std::vector<std::vector<float>>& queries, float radius,
+                                                            size_t max_results = 1000) {
+            std::vector<std::vector<Result>> results(queries.size());
+
+            #pragma omp parallel for schedule(dynamic, 4)
+            for (long long i = 0; i < (long long)queries.size(); ++i) {
+                results[i] = range_search(queries[i].data(), radius, max_results);
+            }
+            return results;
+        }
+
+        // --- Merge ---
+        // Appends every slot of `other` (up to its size()) after this index's size() (ids shift by the
+        // returned offset), copies its metadata, then stitches the two graphs together:
+        // each node of the smaller side is searched in the larger side and cross-linked
+        // in both directions. Must not run concurrently with inserts on either index.
+        id_t merge(HNSW& other) {
+            if (&other == this) throw std::invalid_argument("Cannot merge an index into itself");
+
+            const size_t base = element_count_;
+            const size_t incoming = other.element_count_;
+            if (other.entry_point_id_ == -1 || incoming == 0) return (id_t)base;
+
+            const bool track = stats_.enabled();
+
+            // 1. Grow storage + locks once for the whole batch
+            size_t needed = (base + incoming) * sizeof(Node);
+            if (needed > storage_.get_size()) {
+                std::lock_guard<std::mutex> lock(global_resize_lock_);
+                storage_.resize(needed + 10 * 1024 * 1024);
+                if (track) stats_.record_resize();
+            }
+            for (size_t i = node_locks_.size(); i < base + incoming + 10000; ++i) {
+                node_locks_.push_back(std::make_unique<SpinLock>());
+            }
+
+            // 2. Copy nodes, shifting ids and neighbor ids by `base`
+            #pragma omp parallel for schedule(static)
+            for (long long i = 0; i < (long long)incoming; ++i) {
+                Node* dst = get_node((id_t)(base + i));
+                if (!other.is_stored((id_t)i)) {
+                    std::memset(static_cast<void*>(dst), 0, sizeof(Node)); // Keep holes as holes
+                    continue;
+                }
+                *dst = *other.get_node((id_t)i);
+                dst->id = (id_t)(base + i);
+                for (int l = 0; l < MAX_LAYERS; l++) {
+                    for (int j = 0; j < dst->neighbor_counts[l]; j++) dst->neighbors[l][j] += (id_t)base;
+                }
+            }
+
+            // 3. Metadata (Append-only log, sequential)
+            for (size_t i = 0; i < incoming; ++i) {
+                std::string metadata = other.get_metadata((id_t)i);
+                if (!metadata.empty()) metadata_storage_.save_metadata((int)(base + i), metadata);
+            }
+
+            element_count_ = base + incoming;
+            id_t other_entry = (id_t)(other.entry_point_id_ + base);
+
+            if (entry_point_id_ == -1) {
+                entry_point_id_ = other_entry;
+                current_max_layer_ = other.current_max_layer_;
+                persist_entry_point();
+                return (id_t)base;
+            }
+
+            // 4. Cross-link the smaller graph into the larger one
+            bool other_is_smaller = incoming <= base;
+            size_t small_begin = other_is_smaller ? base : 0;
+            size_t small_end = other_is_smaller ? base + incoming : base;
+            size_t large_begin = other_is_smaller ? 0 : base;
+            size_t large_end = other_is_smaller ? base : base + incoming;
+            id_t large_entry = other_is_smaller ? entry_point_id_ : other_entry;
+            int large_max_layer = other_is_smaller ? current_max_layer_ : other.current_max_layer_;
+
+            #pragma omp parallel for schedule(dynamic, 16)
+            for (long long u = (long long)small_begin; u < (long long)small_end; ++u) {
+                if (!is_stored((id_t)u)) continue;
+                WorkCounters work;
+                Node* node = get_node((id_t)u);
+                int top = std::min(node->max_layer, large_max_layer);
+
+                id_t curr_obj = greedy_descent_from(large_entry, large_max_layer, node->vector, top, work);
+
+                for (int l = top; l >= 0; l--) {
+                    std::priority_queue<Result> candidates = search_layer(curr_obj, node->vector, config::EF_CONSTRUCTION, l, work);
+
+                    // Max-Heap pops farthest first; keep only nodes from the larger side
+                    std::vector<id_t> selected;
+                    while (!candidates.empty()) {
+                        id_t c = candidates.top().id;
+                        candidates.pop();
+                        if (c >= large_begin && c < large_end) selected.push_back(c);
+                    }
+                    std::reverse(selected.begin(), selected.end());
+                    if (selected.size() > (size_t)config::M) selected.resize(config::M);
+
+                    for (id_t neighbor_id : selected) {
+                        add_link((id_t)u, neighbor_id, l, work);
+                        add_link(neighbor_id, (id_t)u, l, work);
+                    }
+                    if (!selected.empty()) curr_obj = selected[0];
+                }
+            }
+
+            // 5. The taller graph provides the entry point
+            if (other.current_max_layer_ > current_max_layer_) {
+                entry_point_id_ = other_entry;
+                current_max_layer_ = other.current_max_layer_;
+                persist_entry_point();
+            }
+
+            return (id_t)base;
+        }
+
         // Helper
         std::string get_metadata(id_t id) {
             return metadata_storage_.get_metadata(id);
         }
 
+        // Slot high-water mark: highest stored id + 1 (ids may be sparse, so this can exceed
+        // the number of vectors; use contains() to skip holes)
+        size_t size() const { return element_count_; }
+
+        // Graph accessors (Read-only walks, e.g. exporting to the tiered layout)
+        id_t entry_point() const { return entry_point_id_; }
+
+        int max_layer() const { return current_max_layer_; }
+
+        bool contains(id_t id) { return id < element_count_ && is_stored(id); }
+
+        const Node* node_at(id_t id) { return get_node(id); }
+
+        // Pointer into the mmap'd node (Warning: invalidated by the next storage resize).
+        // Consecutive vectors are sizeof(Node) bytes apart.
+        const float* get_vector(id_t id) {
+            return get_node(id)->vector;
+        }
+
+        // --- Instrumentation ---
+        // Counters are always gathered per operation; they are only published
+        // (plus latency timing) while stats are enabled.
+        StatsSnapshot stats() const { return stats_.snapshot(); }
+
+        void set_stats_enabled(bool enabled) { stats_.set_enabled(enabled); }
+
+        void reset_stats() { stats_.reset(); }
+
     private:
         MMapHandler& storage_;
         MetadataHandler metadata_storage_; // <--- The Handler
         id_t entry_point_id_ = -1;
         int current_max_layer_ = -1;
-        size_t element_count_ = 0;
+        size_t element_count_ = 0; // High-water mark (highest stored id + 1), not an insert count
         std::mt19937 rng_;
         std::mutex init_lock_;
+        std::mutex count_lock_;
+        std::mutex entry_file_lock_;
+        std::string entry_path_;
         
         std::vector<std::unique_ptr<SpinLock>> node_locks_;
         std::mutex global_resize_lock_;
+        IndexStats stats_;
 
         Node* get_node(id_t id) {
             return reinterpret_cast<Node*>((char*)storage_.get_data() + (size_t)id * sizeof(Node));
         }
 
+        // A written slot holds its own id and an initialized neighbor table
+        // (unused entries are -1), which a zero-filled, preallocated slot never does.
+        bool is_stored(id_t id) {
+            Node* node = get_node(id);
+            return node->id == id && (node->neighbor_counts[0] > 0 || node->neighbors[0][0] != 0);
+        }
+
+        // Reopened file: element count = last written slot + 1 (backward scan over the
+        // unused tail only). The entry point comes from the <index>.entry sidecar; files
+        // without a valid one (older builds) fall back to a full scan for the tallest node.
+        void recover_graph_state(size_t capacity) {
+            size_t last = capacity;
+            while (last > 0 && !is_stored((id_t)(last - 1))) last--;
+            element_count_ = last;
+            if (element_count_ == 0 || load_entry_point()) return;
+
+            for (size_t i = 0; i < element_count_; ++i) {
+                if (!is_stored((id_t)i)) continue;
+                int level = get_node((id_t)i)->max_layer;
+                if (level > current_max_layer_) {
+                    current_max_layer_ = level;
+                    entry_point_id_ = (id_t)i;
+                }
+            }
+            if (entry_point_id_ != (id_t)-1) persist_entry_point();
+        }
+
+        // --- Entry Point Sidecar ---
+        // Rewritten only when the entry point changes (first node, a new top layer, merge),
+        // i.e. O(log n) times over an index's life.
+        struct EntryPointRecord {
+            uint64_t magic;
+            uint64_t entry_point;
+            int32_t max_layer;
+            uint32_t reserved;
+        };
+
+        static constexpr uint64_t ENTRY_MAGIC = 0x314e5452454e4e4eULL; // "NNNENTR1"
+
+        void persist_entry_point() {
+            std::lock_guard<std::mutex> lock(entry_file_lock_);
+            EntryPointRecord rec = {ENTRY_MAGIC, (uint64_t)entry_point_id_, current_max_layer_, 0};
+            std::ofstream out(entry_path_, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+        }
+
+        // Accepts the sidecar only if it still describes a stored node of that height
+        bool load_entry_point() {
+            std::ifstream in(entry_path_, std::ios::binary);
+            EntryPointRecord rec{};
+            if (!in.read(reinterpret_cast<char*>(&rec), sizeof(rec)) || rec.magic != ENTRY_MAGIC) return false;
+            if (rec.entry_point >= element_count_) return false;
+
+            id_t entry = (id_t)rec.entry_point;
+            if (!is_stored(entry) || get_node(entry)->max_layer != rec.max_layer) return false;
+
+            entry_point_id_ = entry;
+            current_max_layer_ = rec.max_layer;
+            return true;
+        }
+
         int get_random_level() {
             std::uniform_real_distribution<double> dist(0.0, 1.0);
             double r = dist(rng_);
@@ -210,7 +510,66 @@ namespace nanodb {
             return level;
         }
 
-        std::priority_queue<Result> search_layer(id_t entry_point, const float* query_vec, int ef, int layer) {
+        // Greedy walk from the entry point down to `stop_layer`, returns the closest node found.
+        id_t greedy_descent(const float* query, int stop_layer, WorkCounters& work) {
+            return greedy_descent_from(entry_point_id_, current_max_layer_, query, stop_layer, work);
+        }
+
+        id_t greedy_descent_from(id_t entry, int top_layer, const float* query, int stop_layer, WorkCounters& work) {
+            id_t curr_obj = entry;
+            float dist = get_distance(query, get_node(curr_obj)->vector, config::VECTOR_DIM);
+            work.distance_computations++;
+
+            for (int l = top_layer; l > stop_layer; l--) {
+                bool changed = true;
+                while (changed) {
+                    changed = false;
+                    Node* curr_node = get_node(curr_obj);
+                    for (int i = 0; i < curr_node->neighbor_counts[l]; i++) {
+                        id_t n_id = curr_node->neighbors[l][i];
+                        float d = get_distance(query, get_node(n_id)->vector, config::VECTOR_DIM);
+                        work.distance_computations++;
+                        if (d < dist) { dist = d; curr_obj = n_id; changed = true; work.hops++; }
+                    }
+                }
+            }
+            return curr_obj;
+        }
+
+        // --- Early Termination State ---
+        // Tracks the best k distances seen so far and the stop conditions of one query.
+        struct EarlyStop {
+            const SearchParams& params;
+            size_t k;
+            IndexStats::Clock::time_point deadline;
+            std::priority_queue<float> top_k; // Max-Heap of the k best distances
+            bool improved = false;
+            int stale_expansions = 0;
+            bool triggered = false;
+
+            EarlyStop(const SearchParams& p, int k_, IndexStats::Clock::time_point start)
+                : params(p), k((size_t)k_), deadline(start + std::chrono::microseconds(p.timeout_us)) {}
+
+            void offer(float dist) {
+                if (top_k.size() < k) { top_k.push(dist); improved = true; }
+                else if (dist < top_k.top()) { top_k.pop(); top_k.push(dist); improved = true; }
+            }
+
+            // Called once per expansion. The clock is only read every 8th call.
+            bool should_stop(const WorkCounters& work) {
+                stale_expansions = improved ? 0 : stale_expansions + 1;
+                improved = false;
+
+                if (params.patience > 0 && stale_expansions >= params.patience) triggered = true;
+                if (params.max_distance_computations > 0 && work.distance_computations >= params.max_distance_computations) triggered = true;
+                if (params.timeout_us > 0 && (work.hops & 7) == 0 && IndexStats::Clock::now() >= deadline) triggered = true;
+                return triggered;
+            }
+        };
+
+        std::priority_queue<Result> search_layer(id_t entry_point, const float* query_vec, int ef, int layer, WorkCounters& work,
+                                                 EarlyStop* early = nullptr) {
+            work.search_layer_calls++;
             std::vector<bool> visited(std::max((size_t)entry_point, element_count_) + 2000, false);
             std::priority_queue<Result, std::vector<Result>, std::greater<Result>> candidates; 
             std::priority_queue<Result> found_results; 
@@ -220,33 +579,118 @@ namespace nanodb {
             candidates.push(start_node);
             found_results.push(start_node);
             if (entry_point < visited.size()) visited[entry_point] = true;
+            work.distance_computations++;
+            work.visited_nodes++;
+            work.heap_operations += 2;
+            if (early) early->offer(d);
 
             while (!candidates.empty()) {
                 Result curr = candidates.top();
                 candidates.pop();
+                work.heap_operations++;
 
                 if (curr.distance > found_results.top().distance && found_results.size() >= (size_t)ef) break;
+                work.hops++;
 
                 Node* curr_node = get_node(curr.id);
                 for (int i = 0; i < curr_node->neighbor_counts[layer]; i++) {
                     id_t neighbor_id = curr_node->neighbors[layer][i];
                     if (neighbor_id >= visited.size() || visited[neighbor_id]) continue;
                     visited[neighbor_id] = true;
+                    work.visited_nodes++;
 
                     float dist = get_distance(query_vec, get_node(neighbor_id)->vector, config::VECTOR_DIM);
+                    work.distance_computations++;
+                    if (early) early->offer(dist);
                     if (found_results.size() < (size_t)ef || dist < found_results.top().distance) {
                         candidates.push({neighbor_id, dist});
                         found_results.push({neighbor_id, dist});
-                        if (found_results.size() > (size_t)ef) found_results.pop();
+                        work.heap_operations += 2;
+                        if (found_results.size() > (size_t)ef) { found_results.pop(); work.heap_operations++; }
                     }
                 }
+
+                if (early && early->should_stop(work)) break;
             }
             return found_results;
         }
 
-        void add_link(id_t src, id_t dest, int layer) {
+        // Best-first walk like search_layer, but every node within `radius` is kept in a
+        // max-heap bounded to max_results. The ef-bounded beam still steers the walk toward the
+        // query; the stop rule is relaxed so we only quit once the closest frontier node lies
+        // outside both the beam and the effective radius, which shrinks to the heap's worst
+        // distance once it is full (so a capped result is the closest max_results, not the first).
+        std::vector<Result> search_layer_range(id_t entry_point, const float* query_vec, float radius, int ef,
+                                               size_t max_results, WorkCounters& work) {
+            work.search_layer_calls++;
+            std::vector<bool> visited(std::max((size_t)entry_point, element_count_) + 2000, false);
+            std::priority_queue<Result, std::vector<Result>, std::greater<Result>> candidates;
+            std::priority_queue<Result> found_results;
+            std::priority_queue<Result> in_range;
+            float bound = radius;
+
+            auto keep = [&](id_t id, float dist) {
+                if (dist > bound) return;
+                in_range.push({id, dist});
+                work.heap_operations++;
+                if (in_range.size() > max_results) { in_range.pop(); work.heap_operations++; }
+                if (in_range.size() == max_results) bound = std::min(radius, in_range.top().distance);
+            };
+
+            float d = get_distance(query_vec, get_node(entry_point)->vector, config::VECTOR_DIM);
+            candidates.push({entry_point, d});
+            found_results.push({entry_point, d});
+            if (entry_point < visited.size()) visited[entry_point] = true;
+            keep(entry_point, d);
+            work.distance_computations++;
+            work.visited_nodes++;
+            work.heap_operations += 2;
+
+            while (!candidates.empty()) {
+                Result curr = candidates.top();
+                candidates.pop();
+                work.heap_operations++;
+
+                bool beam_full = found_results.size() >= (size_t)ef;
+                if (curr.distance > bound && beam_full && curr.distance > found_results.top().distance) break;
+                work.hops++;
+
+                Node* curr_node = get_node(curr.id);
+                for (int i = 0; i < curr_node->neighbor_counts[0]; i++) {
+                    id_t neighbor_id = curr_node->neighbors[0][i];
+                    if (neighbor_id >= visited.size() || visited[neighbor_id]) continue;
+                    visited[neighbor_id] = true;
+                    work.visited_nodes++;
+
+                    float dist = get_distance(query_vec, get_node(neighbor_id)->vector, config::VECTOR_DIM);
+                    work.distance_computations++;
+                    keep(neighbor_id, dist);
+
+                    bool improves_beam = found_results.size() < (size_t)ef || dist < found_results.top().distance;
+                    if (dist <= bound || improves_beam) {
+                        candidates.push({neighbor_id, dist});
+                        work.heap_operations++;
+                    }
+                    if (improves_beam) {
+                        found_results.push({neighbor_id, dist});
+                        work.heap_operations++;
+                        if (found_results.size() > (size_t)ef) { found_results.pop(); work.heap_operations++; }
+                    }
+                }
+            }
+
+            std::vector<Result> results;
+            results.reserve(in_range.size());
+            while (!in_range.empty()) {
+                results.push_back(in_range.top());
+                in_range.pop();
+            }
+            return results;
+        }
+
+        void add_link(id_t src, id_t dest, int layer, WorkCounters& work) {
             if (src >= node_locks_.size()) return; 
-            node_locks_[src]->lock(); 
+            work.lock_spins += node_locks_[src]->lock(); 
 
             Node* node = get_node(src);
             int count = node->neighbor_counts[layer];
@@ -257,6 +701,7 @@ namespace nanodb {
                 node->neighbor_counts[layer]++;
             } else {
                 float dest_dist = get_distance(node->vector, get_node(dest)->vector, config::VECTOR_DIM);
+                work.distance_computations += count + 1;
                 float max_d = -1.0f;
                 int max_idx = -1;
 
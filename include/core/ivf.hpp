@@ -0,0 +1,279 @@
+#pragma once
+
+#include "distance.hpp"
+#include "../common/types.hpp"
+#include "../common/config.hpp"
+#include "../storage/mmap_handler.hpp"
+#include <queue>
+#include <vector>
+#include <random>
+#include <limits>
+#include <numeric>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+namespace nanodb {
+
+    // --- IVF File Header ---
+    // Sits at offset 0 of the mmap file. Everything after it is located by offset,
+    // so the file is relocatable like the HNSW node file.
+    struct alignas(32) IVFHeader {
+        uint64_t magic;
+        uint32_t dim;
+        uint32_t nlist;
+        uint64_t count;
+        uint64_t centroids_offset;  // float[nlist][dim]
+        uint64_t list_offsets_offset; // uint64_t[nlist + 1], prefix sums into ids/vectors
+        uint64_t ids_offset;        // id_t[count], grouped by list
+        uint64_t vectors_offset;    // float[count][dim], grouped by list
+    };
+
+    constexpr uint64_t IVF_MAGIC = 0x314656494f4e414eULL; // "NANOIVF1"
+
+    // --- IVF (Inverted File) Index ---
+    // Bulk-built alternative to HNSW: k-means splits the space into nlist cells and
+    // every vector is stored in its cell's contiguous segment. A query ranks the
+    // centroids, then brute-force scans the nprobe closest segments.
+    // Build is one k-means + one assignment pass, trading recall (tunable via nprobe)
+    // for build throughput.
+    class IVFIndex {
+    public:
+        // --- Constructor ---
+        // Reopens an existing IVF file if the header is valid, otherwise waits for build().
+        // `nlist` is the configured list count for every build(); a reopened file keeps its own
+        // list count for search until it is rebuilt.
+        IVFIndex(MMapHandler& storage, size_t nlist = config::IVF_NLIST)
+            : storage_(storage), nlist_(nlist) {
+            if (nlist_ == 0) throw std::invalid_argument("IVFIndex needs at least one list");
+
+            std::random_device rd;
+            rng_.seed(rd());
+
+            if (storage_.get_size() >= sizeof(IVFHeader) && header()->magic == IVF_MAGIC) {
+                if (header()->dim != config::VECTOR_DIM) throw std::runtime_error("IVF file dimension mismatch");
+                built_ = true;
+            }
+        }
+
+        // --- Public API ---
+
+        void build(const std::vector<std::vector<float>>& vectors, const std::vector<id_t>& ids) {
+            if (vectors.size() != ids.size()) throw std::invalid_argument("vectors and ids must have the same length");
+
+            // Flatten once so training and assignment walk contiguous memory
+            std::vector<float> flat(vectors.size() * config::VECTOR_DIM, 0.0f);
+            for (size_t i = 0; i < vectors.size(); ++i) {
+                size_t copy_size = std::min(vectors[i].size(), config::VECTOR_DIM);
+                std::memcpy(&flat[i * config::VECTOR_DIM], vectors[i].data(), copy_size * sizeof(float));
+            }
+            build(flat.data(), ids.data(), ids.size());
+        }
+
+        // Replaces the file contents with a freshly trained index over `n` row-major vectors.
+        void build(const float* data, const id_t* ids, size_t n) {
+            if (n == 0) throw std::invalid_argument("Cannot build an IVF index from zero vectors");
+            const size_t dim = config::VECTOR_DIM;
+            size_t nlist = std::min(nlist_, n); // Clamped for this build only
+
+            // 1. Train centroids
+            std::vector<float> centroids = train_kmeans(data, n, nlist);
+
+            // 2. Assign every vector to its nearest centroid
+            std::vector<uint32_t> assignment(n);
+            #pragma omp parallel for schedule(static)
+            for (long long i = 0; i < (long long)n; ++i) {
+                assignment[i] = nearest_centroid(centroids.data(), nlist, data + i * dim);
+            }
+
+            // 3. Counting sort -> per-list segments
+            std::vector<uint64_t> list_offsets(nlist + 1, 0);
+            for (size_t i = 0; i < n; ++i) list_offsets[assignment[i] + 1]++;
+            for (size_t l = 0; l < nlist; ++l) list_offsets[l + 1] += list_offsets[l];
+
+            std::vector<uint64_t> slot(n);
+            std::vector<uint64_t> cursor(list_offsets.begin(), list_offsets.end() - 1);
+            for (size_t i = 0; i < n; ++i) slot[i] = cursor[assignment[i]]++;
+
+            // 4. Lay out the file (Warning: resize invalidates any pointer into storage)
+            IVFHeader h{};
+            h.magic = 0; // Only marked valid once fully written
+            h.dim = (uint32_t)dim;
+            h.nlist = (uint32_t)nlist;
+            h.count = n;
+            h.centroids_offset = align_up(sizeof(IVFHeader));
+            h.list_offsets_offset = align_up(h.centroids_offset + nlist * dim * sizeof(float));
+            h.ids_offset = align_up(h.list_offsets_offset + (nlist + 1) * sizeof(uint64_t));
+            h.vectors_offset = align_up(h.ids_offset + n * sizeof(id_t));
+            size_t total_size = h.vectors_offset + n * dim * sizeof(float);
+
+            if (storage_.get_size() < total_size) storage_.resize(total_size);
+
+            char* base = static_cast<char*>(storage_.get_data());
+            std::memcpy(base, &h, sizeof(IVFHeader));
+            std::memcpy(base + h.centroids_offset, centroids.data(), centroids.size() * sizeof(float));
+            std::memcpy(base + h.list_offsets_offset, list_offsets.data(), list_offsets.size() * sizeof(uint64_t));
+
+            id_t* out_ids = reinterpret_cast<id_t*>(base + h.ids_offset);
+            float* out_vecs = reinterpret_cast<float*>(base + h.vectors_offset);
+
+            #pragma omp parallel for schedule(static)
+            for (long long i = 0; i < (long long)n; ++i) {
+                out_ids[slot[i]] = ids[i];
+                std::memcpy(out_vecs + slot[i] * dim, data + i * dim, dim * sizeof(float));
+            }
+
+            header()->magic = IVF_MAGIC;
+            built_ = true;
+        }
+
+        // Queries shorter or longer than VECTOR_DIM are zero-padded / truncated, as in build()
+        std::vector<Result> search(const std::vector<float>& query, int k, int nprobe = config::IVF_NPROBE) {
+            if (query.size() == config::VECTOR_DIM) return search(query.data(), k, nprobe);
+
+            std::vector<float> padded(config::VECTOR_DIM, 0.0f);
+            std::memcpy(padded.data(), query.data(), std::min(query.size(), config::VECTOR_DIM) * sizeof(float));
+            return search(padded.data(), k, nprobe);
+        }
+
+        // Raw-pointer variant: reads exactly VECTOR_DIM floats.
+        std::vector<Result> search(const float* query, int k, int nprobe = config::IVF_NPROBE) {
+            if (!built_ || k <= 0) return {};
+            const size_t dim = config::VECTOR_DIM;
+            const IVFHeader* h = header();
+            const char* base = static_cast<const char*>(storage_.get_data());
+
+            const float* centroids = reinterpret_cast<const float*>(base + h->centroids_offset);
+            const uint64_t* list_offsets = reinterpret_cast<const uint64_t*>(base + h->list_offsets_offset);
+            const id_t* ids = reinterpret_cast<const id_t*>(base + h->ids_offset);
+            const float* vectors = reinterpret_cast<const float*>(base + h->vectors_offset);
+
+            // 1. Rank centroids, keep the nprobe closest
+            std::vector<Result> coarse(h->nlist);
+            for (uint32_t l = 0; l < h->nlist; ++l) {
+                coarse[l] = {l, get_distance(query, centroids + (size_t)l * dim, dim)};
+            }
+            size_t probes = std::min((size_t)std::max(nprobe, 1), coarse.size());
+            std::partial_sort(coarse.begin(), coarse.begin() + probes, coarse.end());
+
+            // 2. Sequential scan of each probed segment (Max-Heap keeps the best k)
+            std::priority_queue<Result> top_candidates;
+            for (size_t p = 0; p < probes; ++p) {
+                uint32_t l = coarse[p].id;
+                for (uint64_t i = list_offsets[l]; i < list_offsets[l + 1]; ++i) {
+                    float d = get_distance(query, vectors + i * dim, dim);
+                    if (top_candidates.size() < (size_t)k) {
+                        top_candidates.push({ids[i], d});
+                    } else if (d < top_candidates.top().distance) {
+                        top_candidates.pop();
+                        top_candidates.push({ids[i], d});
+                    }
+                }
+            }
+
+            std::vector<Result> results;
+            while (!top_candidates.empty()) {
+                results.push_back(top_candidates.top());
+                top_candidates.pop();
+            }
+            std::reverse(results.begin(), results.end());
+            return results;
+        }
+
+        // Helpers
+        size_t size() const { return built_ ? header()->count : 0; }
+
+        // Lists in the current file (the configured count until the first build)
+        size_t num_lists() const { return built_ ? header()->nlist : nlist_; }
+
+    private:
+        MMapHandler& storage_;
+        size_t nlist_; // Configured list count, never overwritten by a build
+        bool built_ = false;
+        std::mt19937 rng_;
+
+        IVFHeader* header() const {
+            return reinterpret_cast<IVFHeader*>(storage_.get_data());
+        }
+
+        static size_t align_up(size_t offset) {
+            return (offset + 31) & ~size_t(31); // Keep segments 32-byte aligned for AVX2
+        }
+
+        static uint32_t nearest_centroid(const float* centroids, size_t nlist, const float* vec) {
+            uint32_t best = 0;
+            float best_d = std::numeric_limits<float>::max();
+            for (size_t c = 0; c < nlist; ++c) {
+                float d = get_distance(vec, centroids + c * config::VECTOR_DIM, config::VECTOR_DIM);
+                if (d < best_d) { best_d = d; best = (uint32_t)c; }
+            }
+            return best;
+        }
+
+        // Lloyd's k-means on a random sample. Assignment is parallel; each thread keeps
+        // private sums which are reduced once per iteration.
+        std::vector<float> train_kmeans(const float* data, size_t n, size_t nlist) {
+            const size_t dim = config::VECTOR_DIM;
+
+            // 1. Sample training points
+            std::vector<size_t> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), rng_);
+            size_t n_train = std::min(n, nlist * config::IVF_TRAIN_SAMPLES_PER_LIST);
+
+            std::vector<float> train(n_train * dim);
+            for (size_t i = 0; i < n_train; ++i) {
+                std::memcpy(&train[i * dim], data + order[i] * dim, dim * sizeof(float));
+            }
+
+            // 2. Seed centroids with distinct sample points
+            std::vector<float> centroids(train.begin(), train.begin() + nlist * dim);
+            std::vector<uint32_t> assignment(n_train);
+
+            for (int iter = 0; iter < config::IVF_KMEANS_ITERS; ++iter) {
+                // 3. Assign
+                #pragma omp parallel for schedule(static)
+                for (long long i = 0; i < (long long)n_train; ++i) {
+                    assignment[i] = nearest_centroid(centroids.data(), nlist, &train[i * dim]);
+                }
+
+                // 4. Update (Per-thread partial sums, reduced after the parallel region)
+                std::vector<double> sums(nlist * dim, 0.0);
+                std::vector<size_t> counts(nlist, 0);
+
+                #pragma omp parallel
+                {
+                    std::vector<double> local_sums(nlist * dim, 0.0);
+                    std::vector<size_t> local_counts(nlist, 0);
+
+                    #pragma omp for schedule(static) nowait
+                    for (long long i = 0; i < (long long)n_train; ++i) {
+                        uint32_t c = assignment[i];
+                        local_counts[c]++;
+                        for (size_t j = 0; j < dim; ++j) local_sums[c * dim + j] += train[i * dim + j];
+                    }
+
+                    #pragma omp critical
+                    {
+                        for (size_t j = 0; j < sums.size(); ++j) sums[j] += local_sums[j];
+                        for (size_t c = 0; c < nlist; ++c) counts[c] += local_counts[c];
+                    }
+                }
+
+                std::uniform_int_distribution<size_t> pick(0, n_train - 1);
+                for (size_t c = 0; c < nlist; ++c) {
+                    if (counts[c] == 0) {
+                        // Empty cell: re-seed from a random training point
+                        std::memcpy(&centroids[c * dim], &train[pick(rng_) * dim], dim * sizeof(float));
+                        continue;
+                    }
+                    for (size_t j = 0; j < dim; ++j) centroids[c * dim + j] = (float)(sums[c * dim + j] / counts[c]);
+                }
+            }
+
+            return centroids;
+        }
+    };
+
+} // namespace nanodb
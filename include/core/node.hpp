@@ -37,11 +37,15 @@ namespace nanodb {
         Node() = default; // Needed for casting raw memory
 
         Node(id_t external_id, int level, const std::vector<float>& vec_data) 
+            : Node(external_id, level, vec_data.data(), vec_data.size()) {}
+
+        // Raw buffer variant (e.g. a NumPy array), `dim` floats starting at vec_data
+        Node(id_t external_id, int level, const float* vec_data, size_t dim)
             : id(external_id), max_layer(level) {
             
             // Safe copy of vector data
-            size_t copy_size = (vec_data.size() > config::VECTOR_DIM) ? config::VECTOR_DIM : vec_data.size();
-            std::memcpy(vector, vec_data.data(), copy_size * sizeof(float));
+            size_t copy_size = (dim > config::VECTOR_DIM) ? config::VECTOR_DIM : dim;
+            std::memcpy(vector, vec_data, copy_size * sizeof(float));
 
             // Initialize neighbor lists to empty (-1)
             std::memset(neighbor_counts, 0, sizeof(neighbor_counts));
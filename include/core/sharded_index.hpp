@@ -0,0 +1,139 @@
+#pragma once
+
+#include "hnsw.hpp"
+#include "../storage/mmap_handler.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+namespace nanodb {
+
+    // --- Sharded Collection ---
+    // Splits one logical collection across N independent HNSW graphs, each backed by
+    // its own mmap file + metadata log. Shards share nothing (no resize mutex, no entry
+    // point), so inserts into different shards never contend and queries fan out.
+    //
+    // Routing: global id -> shard (id % N), local slot (id / N).
+    // Local slots stay dense, so each shard file grows like a standalone index.
+    class ShardedIndex {
+    public:
+        // --- Constructor ---
+        // Opens (or creates) shard_<i>.ndb / shard_<i>.meta inside `directory`.
+        ShardedIndex(const std::string& directory, size_t num_shards, size_t initial_shard_size = 10 * 1024 * 1024)
+            : directory_(directory), initial_shard_size_(initial_shard_size) {
+            if (num_shards == 0) throw std::invalid_argument("ShardedIndex needs at least one shard");
+
+            std::filesystem::create_directories(directory_);
+
+            shards_.resize(num_shards);
+            for (size_t s = 0; s < num_shards; ++s) open_shard(s);
+        }
+
+        // --- Public API ---
+
+        void insert(const std::vector<float>& vec_data, id_t id, const std::string& metadata = "") {
+            Shard& shard = shards_[shard_of(id)];
+            shard.index->insert(vec_data, local_id(id), metadata);
+        }
+
+        // Bulk insert. Items are bucketed per shard, then shards are filled in parallel.
+        // Within a shard inserts stay sequential (one writer per graph).
+        void insert_batch(const std::vector<std::vector<float>>& vectors, const std::vector<id_t>& ids,
+                          const std::vector<std::string>& metadata = {}) {
+            if (vectors.size() != ids.size()) throw std::invalid_argument("vectors and ids must have the same length");
+            if (!metadata.empty() && metadata.size() != ids.size()) throw std::invalid_argument("metadata must be empty or match ids");
+
+            // 1. Bucket item positions by destination shard
+            std::vector<std::vector<size_t>> buckets(shards_.size());
+            for (size_t i = 0; i < ids.size(); ++i) buckets[shard_of(ids[i])].push_back(i);
+
+            // 2. One task per shard
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int s = 0; s < (int)shards_.size(); ++s) {
+                HNSW& index = *shards_[s].index;
+                for (size_t i : buckets[s]) {
+                    index.insert(vectors[i], local_id(ids[i]), metadata.empty() ? std::string() : metadata[i]);
+                }
+            }
+        }
+
+        // Fan-out query: every shard returns its local top-k, then we merge to a global top-k.
+        std::vector<Result> search(const std::vector<float>& query, int k) {
+            std::vector<std::vector<Result>> partial(shards_.size());
+
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int s = 0; s < (int)shards_.size(); ++s) {
+                partial[s] = shards_[s].index->search(query, k);
+            }
+
+            return merge_top_k(partial, k);
+        }
+
+        // Drops a shard's files and reopens it empty so it can be rebuilt on its own.
+        // Ids routed to this shard must be re-inserted by the caller.
+        void clear_shard(size_t shard) {
+            if (shard >= shards_.size()) throw std::out_of_range("Shard index out of range");
+
+            Shard& s = shards_[shard];
+            s.index.reset(); // Closes metadata stream
+            s.storage.reset(); // Unmaps vector file
+
+            std::filesystem::remove(shard_path(shard, ".ndb"));
+            std::filesystem::remove(shard_path(shard, ".ndb.entry"));
+            std::filesystem::remove(shard_path(shard, ".meta"));
+
+            open_shard(shard);
+        }
+
+        // Helpers
+        size_t num_shards() const { return shards_.size(); }
+
+        size_t shard_of(id_t id) const { return id % shards_.size(); }
+
+        std::string shard_path(size_t shard, const std::string& extension) const {
+            return (std::filesystem::path(directory_) / ("shard_" + std::to_string(shard) + extension)).string();
+        }
+
+    private:
+        struct Shard {
+            std::unique_ptr<MMapHandler> storage; // HNSW keeps a reference, so the address must be stable
+            std::unique_ptr<HNSW> index;
+        };
+
+        std::string directory_;
+        size_t initial_shard_size_;
+        std::vector<Shard> shards_;
+
+        id_t local_id(id_t id) const { return id / shards_.size(); }
+
+        id_t global_id(id_t local, size_t shard) const { return local * shards_.size() + shard; }
+
+        void open_shard(size_t shard) {
+            Shard& s = shards_[shard];
+            s.storage = std::make_unique<MMapHandler>();
+            s.storage->open_file(shard_path(shard, ".ndb"), initial_shard_size_);
+            s.index = std::make_unique<HNSW>(*s.storage, shard_path(shard, ".meta"));
+        }
+
+        // Each shard returns at most k results, so a partial sort over N*k entries is cheap.
+        std::vector<Result> merge_top_k(std::vector<std::vector<Result>>& partial, int k) const {
+            std::vector<Result> merged;
+            for (size_t s = 0; s < partial.size(); ++s) {
+                for (Result& r : partial[s]) {
+                    r.id = global_id(r.id, s);
+                    merged.push_back(std::move(r));
+                }
+            }
+
+            size_t top = std::min(merged.size(), (size_t)std::max(k, 0));
+            std::partial_sort(merged.begin(), merged.begin() + top, merged.end());
+            merged.resize(top);
+            return merged;
+        }
+    };
+
+} // namespace nanodb
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace nanodb {
+
+    // --- Per-Operation Work Counters ---
+    // Plain integers, bumped on the hot path without synchronization.
+    // Each search/insert owns one and flushes it into IndexStats once at the end.
+    struct WorkCounters {
+        uint64_t distance_computations = 0;
+        uint64_t hops = 0;            // Nodes expanded (greedy moves + search_layer pops)
+        uint64_t visited_nodes = 0;   // Nodes marked visited in search_layer
+        uint64_t heap_operations = 0; // Pushes + pops on candidate / result queues
+        uint64_t lock_spins = 0;      // SpinLock busy-wait iterations in add_link
+        uint64_t search_layer_calls = 0;
+
+        WorkCounters& operator+=(const WorkCounters& other) {
+            distance_computations += other.distance_computations;
+            hops += other.hops;
+            visited_nodes += other.visited_nodes;
+            heap_operations += other.heap_operations;
+            lock_spins += other.lock_spins;
+            search_layer_calls += other.search_layer_calls;
+            return *this;
+        }
+    };
+
+    // --- Latency Histogram Snapshot ---
+    struct HistogramSnapshot {
+        std::vector<uint64_t> buckets; // buckets[i] counts samples in [2^i, 2^(i+1)) ns
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+
+        double mean_us() const { return count ? (double)total_ns / count / 1000.0 : 0.0; }
+
+        // Upper bound of the bucket holding the p-th percentile (p in [0, 1]).
+        double percentile_us(double p) const {
+            if (count == 0) return 0.0;
+            uint64_t target = (uint64_t)(p * count);
+            if (target == 0) target = 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                seen += buckets[i];
+                if (seen >= target) return (double)(1ULL << (i + 1)) / 1000.0;
+            }
+            return (double)(1ULL << buckets.size()) / 1000.0;
+        }
+    };
+
+    // --- Latency Histogram ---
+    // Log2 buckets of nanoseconds: one atomic increment per sample, no allocation.
+    class LatencyHistogram {
+    public:
+        static constexpr int NUM_BUCKETS = 40; // Up to ~18 minutes
+
+        LatencyHistogram() { reset(); }
+
+        void record(uint64_t ns) {
+            int bucket = 0;
+            while ((ns >> (bucket + 1)) != 0 && bucket < NUM_BUCKETS - 1) bucket++;
+            buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+            total_ns_.fetch_add(ns, std::memory_order_relaxed);
+        }
+
+        void reset() {
+            for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+            count_.store(0, std::memory_order_relaxed);
+            total_ns_.store(0, std::memory_order_relaxed);
+        }
+
+        HistogramSnapshot snapshot() const {
+            HistogramSnapshot s;
+            s.buckets.resize(NUM_BUCKETS);
+            for (int i = 0; i < NUM_BUCKETS; ++i) s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+            s.count = count_.load(std::memory_order_relaxed);
+            s.total_ns = total_ns_.load(std::memory_order_relaxed);
+            return s;
+        }
+
+    private:
+        std::atomic<uint64_t> buckets_[NUM_BUCKETS];
+        std::atomic<uint64_t> count_;
+        std::atomic<uint64_t> total_ns_;
+    };
+
+    // --- Stats Snapshot ---
+    // Copyable view returned by HNSW::stats().
+    struct StatsSnapshot {
+        bool enabled = false;
+        uint64_t searches = 0;
+        uint64_t inserts = 0;
+        uint64_t mmap_resizes = 0;
+        uint64_t metadata_reads = 0;
+
+        WorkCounters search_work;
+        WorkCounters insert_work;
+
+        HistogramSnapshot search_latency;
+        HistogramSnapshot insert_latency;
+        HistogramSnapshot metadata_read_latency;
+    };
+
+    // --- Index Stats ---
+    // Shared aggregate. Disabled by default: when off, the hot path only touches the
+    // stack-local WorkCounters and skips clock reads and atomics entirely.
+    class IndexStats {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+        void set_enabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+
+        static uint64_t elapsed_ns(Clock::time_point start) {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        }
+
+        void record_search(const WorkCounters& work, uint64_t ns) {
+            searches_.fetch_add(1, std::memory_order_relaxed);
+            search_work_.add(work);
+            search_latency_.record(ns);
+        }
+
+        void record_insert(const WorkCounters& work, uint64_t ns) {
+            inserts_.fetch_add(1, std::memory_order_relaxed);
+            insert_work_.add(work);
+            insert_latency_.record(ns);
+        }
+
+        void record_metadata_read(uint64_t ns) {
+            metadata_reads_.fetch_add(1, std::memory_order_relaxed);
+            metadata_read_latency_.record(ns);
+        }
+
+        void record_resize() { mmap_resizes_.fetch_add(1, std::memory_order_relaxed); }
+
+        StatsSnapshot snapshot() const {
+            StatsSnapshot s;
+            s.enabled = enabled();
+            s.searches = searches_.load(std::memory_order_relaxed);
+            s.inserts = inserts_.load(std::memory_order_relaxed);
+            s.mmap_resizes = mmap_resizes_.load(std::memory_order_relaxed);
+            s.metadata_reads = metadata_reads_.load(std::memory_order_relaxed);
+            s.search_work = search_work_.load();
+            s.insert_work = insert_work_.load();
+            s.search_latency = search_latency_.snapshot();
+            s.insert_latency = insert_latency_.snapshot();
+            s.metadata_read_latency = metadata_read_latency_.snapshot();
+            return s;
+        }
+
+        void reset() {
+            searches_.store(0, std::memory_order_relaxed);
+            inserts_.store(0, std::memory_order_relaxed);
+            mmap_resizes_.store(0, std::memory_order_relaxed);
+            metadata_reads_.store(0, std::memory_order_relaxed);
+            search_work_.reset();
+            insert_work_.reset();
+            search_latency_.reset();
+            insert_latency_.reset();
+            metadata_read_latency_.reset();
+        }
+
+    private:
+        // Atomic mirror of WorkCounters
+        struct AtomicWorkCounters {
+            std::atomic<uint64_t> distance_computations{0};
+            std::atomic<uint64_t> hops{0};
+            std::atomic<uint64_t> visited_nodes{0};
+            std::atomic<uint64_t> heap_operations{0};
+            std::atomic<uint64_t> lock_spins{0};
+            std::atomic<uint64_t> search_layer_calls{0};
+
+            void add(const WorkCounters& w) {
+                distance_computations.fetch_add(w.distance_computations, std::memory_order_relaxed);
+                hops.fetch_add(w.hops, std::memory_order_relaxed);
+                visited_nodes.fetch_add(w.visited_nodes, std::memory_order_relaxed);
+                heap_operations.fetch_add(w.heap_operations, std::memory_order_relaxed);
+                lock_spins.fetch_add(w.lock_spins, std::memory_order_relaxed);
+                search_layer_calls.fetch_add(w.search_layer_calls, std::memory_order_relaxed);
+            }
+
+            WorkCounters load() const {
+                WorkCounters w;
+                w.distance_computations = distance_computations.load(std::memory_order_relaxed);
+                w.hops = hops.load(std::memory_order_relaxed);
+                w.visited_nodes = visited_nodes.load(std::memory_order_relaxed);
+                w.heap_operations = heap_operations.load(std::memory_order_relaxed);
+                w.lock_spins = lock_spins.load(std::memory_order_relaxed);
+                w.search_layer_calls = search_layer_calls.load(std::memory_order_relaxed);
+                return w;
+            }
+
+            void reset() {
+                distance_computations.store(0, std::memory_order_relaxed);
+                hops.store(0, std::memory_order_relaxed);
+                visited_nodes.store(0, std::memory_order_relaxed);
+                heap_operations.store(0, std::memory_order_relaxed);
+                lock_spins.store(0, std::memory_order_relaxed);
+                search_layer_calls.store(0, std::memory_order_relaxed);
+            }
+        };
+
+        std::atomic<bool> enabled_{false};
+        std::atomic<uint64_t> searches_{0};
+        std::atomic<uint64_t> inserts_{0};
+        std::atomic<uint64_t> mmap_resizes_{0};
+        std::atomic<uint64_t> metadata_reads_{0};
+
+        AtomicWorkCounters search_work_;
+        AtomicWorkCounters insert_work_;
+
+        LatencyHistogram search_latency_;
+        LatencyHistogram insert_latency_;
+        LatencyHistogram metadata_read_latency_;
+    };
+
+} // namespace nanodb
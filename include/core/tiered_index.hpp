@@ -0,0 +1,422 @@
+#pragma once
+
+#include "hnsw.hpp"
+#include "node.hpp"
+#include "distance.hpp"
+#include "../common/config.hpp"
+#include "../common/types.hpp"
+#include "../storage/async_reader.hpp"
+#include <queue>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <memory>
+#include <limits>
+#include <fstream>
+#include <exception>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+namespace nanodb {
+
+    // --- Tiered File Header ---
+    // <prefix>.graph: header | vmin[dim] | vscale[dim] | codes[count][dim]
+    //                 | link_offsets[count * MAX_LAYERS + 1] | links[num_links]
+    // <prefix>.vec:   full-precision vectors, one per vector_stride bytes (sector aligned)
+    struct TieredHeader {
+        uint64_t magic;
+        uint32_t dim;
+        int32_t max_layer;
+        uint64_t count;
+        uint64_t entry_point;
+        uint64_t vector_stride;
+        uint64_t num_links;
+    };
+
+    constexpr uint64_t TIERED_MAGIC = 0x3252454954494e4eULL; // "NNITIER2"
+
+    // --- Tiered Index (Graph in RAM, Vectors on SSD) ---
+    // Read-only serving layout exported from an HNSW index. The graph (compact CSR links)
+    // and 8-bit scalar-quantized codes live in RAM; traversal runs entirely on the codes.
+    // The best `rerank` approximate candidates are then re-scored with exact vectors fetched
+    // from the .vec file through batched O_DIRECT reads (io_uring where available).
+    // search_batch pipelines queries per thread: the reads for query i are in flight while
+    // query i+1 is traversed.
+    class TieredIndex {
+    public:
+        // --- Export ---
+        // Writes <prefix>.graph and <prefix>.vec from an existing index.
+        static void build(HNSW& source, const std::string& prefix) {
+            if (source.entry_point() == (id_t)-1) throw std::invalid_argument("Cannot export an empty index");
+
+            // Every slot up to the high-water mark; holes export as empty nodes
+            const size_t n = source.size();
+            if (!source.contains(source.entry_point())) throw std::runtime_error("Entry point is not a stored node");
+            const size_t dim = config::VECTOR_DIM;
+            const size_t stride = align_up(dim * sizeof(float), config::DIRECT_IO_ALIGNMENT);
+
+            // 1. Per-dimension quantizer range
+            std::vector<float> vmin(dim, std::numeric_limits<float>::max());
+            std::vector<float> vmax(dim, std::numeric_limits<float>::lowest());
+            for (size_t i = 0; i < n; ++i) {
+                if (!source.contains((id_t)i)) continue;
+                const float* v = source.node_at((id_t)i)->vector;
+                for (size_t j = 0; j < dim; ++j) {
+                    vmin[j] = std::min(vmin[j], v[j]);
+                    vmax[j] = std::max(vmax[j], v[j]);
+                }
+            }
+            std::vector<float> vscale(dim);
+            for (size_t j = 0; j < dim; ++j) {
+                float range = vmax[j] - vmin[j];
+                vscale[j] = range > 0.0f ? range / 255.0f : 1.0f;
+            }
+
+            // 2. Codes + CSR links (Holes get zero codes and no links)
+            std::vector<uint8_t> codes(n * dim, 0);
+            std::vector<uint64_t> link_offsets(n * MAX_LAYERS + 1, 0);
+            std::vector<id_t> links;
+
+            std::ofstream vec_file(prefix + ".vec", std::ios::binary | std::ios::trunc);
+            if (!vec_file) throw std::runtime_error("Failed to create " + prefix + ".vec");
+            std::vector<char> row(stride, 0);
+
+            for (size_t i = 0; i < n; ++i) {
+                std::memset(row.data(), 0, stride);
+                const bool stored = source.contains((id_t)i);
+
+                if (stored) {
+                    const Node* node = source.node_at((id_t)i);
+                    std::memcpy(row.data(), node->vector, dim * sizeof(float));
+
+                    for (size_t j = 0; j < dim; ++j) {
+                        float q = (node->vector[j] - vmin[j]) / vscale[j];
+                        codes[i * dim + j] = (uint8_t)std::min(255.0f, std::max(0.0f, std::round(q)));
+                    }
+                }
+
+                // Layers above the node's level (and holes) get empty ranges. Links to
+                // anything that is not a stored slot below n are dropped.
+                for (int l = 0; l < MAX_LAYERS; l++) {
+                    if (stored && l <= source.node_at((id_t)i)->max_layer) {
+                        const Node* node = source.node_at((id_t)i);
+                        for (int j = 0; j < node->neighbor_counts[l]; j++) {
+                            id_t neighbor_id = node->neighbors[l][j];
+                            if (source.contains(neighbor_id)) links.push_back(neighbor_id);
+                        }
+                    }
+                    link_offsets[i * MAX_LAYERS + l + 1] = links.size();
+                }
+
+                vec_file.write(row.data(), stride);
+            }
+            if (!vec_file) throw std::runtime_error("Failed to write " + prefix + ".vec");
+
+            // 3. Graph file
+            TieredHeader h{};
+            h.magic = TIERED_MAGIC;
+            h.dim = (uint32_t)dim;
+            h.max_layer = source.max_layer();
+            h.count = n;
+            h.entry_point = source.entry_point();
+            h.vector_stride = stride;
+            h.num_links = links.size();
+
+            std::ofstream graph_file(prefix + ".graph", std::ios::binary | std::ios::trunc);
+            if (!graph_file) throw std::runtime_error("Failed to create " + prefix + ".graph");
+            graph_file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            write_array(graph_file, vmin);
+            write_array(graph_file, vscale);
+            write_array(graph_file, codes);
+            write_array(graph_file, link_offsets);
+            write_array(graph_file, links);
+            if (!graph_file) throw std::runtime_error("Failed to write " + prefix + ".graph");
+        }
+
+        // --- Constructor ---
+        // Loads the graph + codes into RAM and opens the .vec file once up front, so a missing
+        // or truncated vector file fails here. Other workers open their own reader on first use.
+        explicit TieredIndex(const std::string& prefix, size_t rerank = config::TIERED_RERANK, bool direct_io = true)
+            : vec_path_(prefix + ".vec"), rerank_(rerank), direct_io_(direct_io) {
+            std::ifstream graph_file(prefix + ".graph", std::ios::binary);
+            if (!graph_file) throw std::runtime_error("Failed to open " + prefix + ".graph");
+
+            graph_file.read(reinterpret_cast<char*>(&header_), sizeof(header_));
+            if (!graph_file || header_.magic != TIERED_MAGIC) throw std::runtime_error("Not a tiered index: " + prefix);
+            if (header_.dim != config::VECTOR_DIM) throw std::runtime_error("Tiered index dimension mismatch");
+
+            const size_t n = header_.count;
+            const size_t dim = header_.dim;
+            read_array(graph_file, vmin_, dim);
+            read_array(graph_file, vscale_, dim);
+            read_array(graph_file, codes_, n * dim);
+            read_array(graph_file, link_offsets_, n * MAX_LAYERS + 1);
+            read_array(graph_file, links_, header_.num_links);
+            if (!graph_file) throw std::runtime_error("Truncated tiered index: " + prefix);
+
+            // Traversal indexes codes / offsets by these ids without bounds checks
+            if (header_.entry_point >= n) throw std::runtime_error("Corrupt tiered index (entry point): " + prefix);
+            if (link_offsets_.front() != 0 || link_offsets_.back() != header_.num_links) throw std::runtime_error("Corrupt tiered index (links): " + prefix);
+            for (size_t i = 0; i + 1 < link_offsets_.size(); ++i) {
+                if (link_offsets_[i] > link_offsets_[i + 1]) throw std::runtime_error("Corrupt tiered index (links): " + prefix);
+            }
+            for (id_t neighbor_id : links_) {
+                if (neighbor_id >= n) throw std::runtime_error("Corrupt tiered index (links): " + prefix);
+            }
+
+            std::error_code ec;
+            uintmax_t vec_size = std::filesystem::file_size(vec_path_, ec);
+            if (ec) throw std::runtime_error("Failed to open " + vec_path_);
+            if (vec_size < n * header_.vector_stride) throw std::runtime_error("Truncated vector file: " + vec_path_);
+
+            for (int t = 0; t < omp_get_max_threads(); ++t) slots_.push_back(std::make_unique<IOSlot>());
+            ensure_open(*slots_[0]);
+        }
+
+        // --- Public API ---
+
+        // Queries shorter or longer than VECTOR_DIM are zero-padded / truncated
+        std::vector<Result> search(const std::vector<float>& query, int k) {
+            if (query.size() == config::VECTOR_DIM) return search_batch(query.data(), 1, k)[0];
+
+            std::vector<float> padded(config::VECTOR_DIM, 0.0f);
+            std::memcpy(padded.data(), query.data(), std::min(query.size(), config::VECTOR_DIM) * sizeof(float));
+            return search_batch(padded.data(), 1, k)[0];
+        }
+
+        // `n` row-major queries. Each OpenMP thread owns one reader and one contiguous
+        // slice of the batch, overlapping its disk reads with the next traversal.
+        std::vector<std::vector<Result>> search_batch(const float* queries, size_t n, int k) {
+            std::vector<std::vector<Result>> results(n);
+            if (n == 0 || k <= 0) return results;
+
+            int workers = (int)std::min(slots_.size(), n);
+            std::vector<std::exception_ptr> errors(workers);
+
+            #pragma omp parallel num_threads(workers)
+            {
+                int tid = omp_get_thread_num();
+                int team = omp_get_num_threads();
+                size_t begin = n * tid / team;
+                size_t end = n * (tid + 1) / team;
+
+                // Exceptions must not escape the parallel region: park them per worker
+                IOSlot& slot = *slots_[tid];
+                std::lock_guard<std::mutex> lock(slot.lock); // Guards against concurrent external callers
+                try {
+                    run_pipeline(slot, queries, begin, end, k, results);
+                } catch (...) {
+                    errors[tid] = std::current_exception();
+                    reset_slot(slot);
+                }
+            }
+
+            for (const std::exception_ptr& e : errors) {
+                if (e) std::rethrow_exception(e);
+            }
+            return results;
+        }
+
+        std::vector<std::vector<Result>> search_batch(const std::vector<std::vector<float>>& queries, int k) {
+            std::vector<float> block(queries.size() * config::VECTOR_DIM, 0.0f);
+            for (size_t i = 0; i < queries.size(); ++i) {
+                size_t copy_size = std::min(queries[i].size(), config::VECTOR_DIM);
+                std::memcpy(&block[i * config::VECTOR_DIM], queries[i].data(), copy_size * sizeof(float));
+            }
+            return search_batch(block.data(), queries.size(), k);
+        }
+
+        // Helpers
+        size_t size() const { return header_.count; }
+
+        // I/O mode actually obtained after any fallback (probed on the first worker's reader)
+        bool is_direct() { return ensure_open(*slots_[0]).is_direct(); }
+
+        bool is_async() { return ensure_open(*slots_[0]).is_async(); }
+
+    private:
+        // Per-worker I/O state: one reader (ring) and one aligned landing buffer
+        struct IOSlot {
+            AsyncReader reader;
+            bool opened = false;
+            std::mutex lock;
+            char* buffer = nullptr;
+            size_t capacity = 0;
+            std::vector<ReadRequest> requests;
+
+            ~IOSlot() {
+                reader.close_file(); // Land any in-flight reads before their buffer goes
+                aligned_buffer_free(buffer);
+            }
+        };
+
+        TieredHeader header_{};
+        std::vector<float> vmin_;
+        std::vector<float> vscale_;
+        std::vector<uint8_t> codes_;
+        std::vector<uint64_t> link_offsets_;
+        std::vector<id_t> links_;
+
+        std::string vec_path_;
+        size_t rerank_;
+        bool direct_io_;
+        std::vector<std::unique_ptr<IOSlot>> slots_;
+
+        static size_t align_up(size_t size, size_t alignment) {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        template <typename T>
+        static void write_array(std::ofstream& out, const std::vector<T>& data) {
+            out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+        }
+
+        template <typename T>
+        static void read_array(std::ifstream& in, std::vector<T>& data, size_t count) {
+            data.resize(count);
+            in.read(reinterpret_cast<char*>(data.data()), count * sizeof(T));
+        }
+
+        AsyncReader& ensure_open(IOSlot& slot) {
+            if (!slot.opened) {
+                slot.reader.open_file(vec_path_, direct_io_, config::ASYNC_QUEUE_DEPTH);
+                slot.opened = true;
+            }
+            return slot.reader;
+        }
+
+        // After a failed pipeline: drain or cancel whatever is still in flight so the
+        // buffer can be reused, and reopen the reader on the next call
+        static void reset_slot(IOSlot& slot) {
+            slot.reader.close_file();
+            slot.opened = false;
+        }
+
+        float approx_distance(const float* query, id_t id) const {
+            return get_distance_sq8(query, &codes_[(size_t)id * header_.dim], vmin_.data(), vscale_.data(), header_.dim);
+        }
+
+        // Same walk as HNSW::search, but over the in-RAM codes and CSR links.
+        // Returns up to ef approximate candidates, closest first.
+        std::vector<Result> traverse(const float* query, int ef) const {
+            id_t curr_obj = (id_t)header_.entry_point;
+            float dist = approx_distance(query, curr_obj);
+
+            for (int l = header_.max_layer; l > 0; l--) {
+                bool changed = true;
+                while (changed) {
+                    changed = false;
+                    size_t slot = (size_t)curr_obj * MAX_LAYERS + l;
+                    for (uint64_t e = link_offsets_[slot]; e < link_offsets_[slot + 1]; ++e) {
+                        float d = approx_distance(query, links_[e]);
+                        if (d < dist) { dist = d; curr_obj = links_[e]; changed = true; }
+                    }
+                }
+            }
+
+            std::vector<bool> visited(header_.count, false);
+            std::priority_queue<Result, std::vector<Result>, std::greater<Result>> candidates;
+            std::priority_queue<Result> found_results;
+
+            candidates.push({curr_obj, dist});
+            found_results.push({curr_obj, dist});
+            visited[curr_obj] = true;
+
+            while (!candidates.empty()) {
+                Result curr = candidates.top();
+                candidates.pop();
+
+                if (curr.distance > found_results.top().distance && found_results.size() >= (size_t)ef) break;
+
+                size_t slot = (size_t)curr.id * MAX_LAYERS;
+                for (uint64_t e = link_offsets_[slot]; e < link_offsets_[slot + 1]; ++e) {
+                    id_t neighbor_id = links_[e];
+                    if (neighbor_id >= visited.size() || visited[neighbor_id]) continue;
+                    visited[neighbor_id] = true;
+
+                    float d = approx_distance(query, neighbor_id);
+                    if (found_results.size() < (size_t)ef || d < found_results.top().distance) {
+                        candidates.push({neighbor_id, d});
+                        found_results.push({neighbor_id, d});
+                        if (found_results.size() > (size_t)ef) found_results.pop();
+                    }
+                }
+            }
+
+            std::vector<Result> ordered;
+            while (!found_results.empty()) {
+                ordered.push_back(found_results.top());
+                found_results.pop();
+            }
+            std::reverse(ordered.begin(), ordered.end());
+            return ordered;
+        }
+
+        // Queue exact-vector reads for the first `count` candidates (does not wait)
+        void submit_rerank(IOSlot& slot, const std::vector<Result>& candidates, size_t count) {
+            const size_t stride = header_.vector_stride;
+            if (slot.capacity < count * stride) {
+                aligned_buffer_free(slot.buffer);
+                slot.buffer = nullptr;
+                slot.capacity = 0;
+                size_t capacity = align_up(count * stride, config::DIRECT_IO_ALIGNMENT);
+                slot.buffer = static_cast<char*>(aligned_buffer_alloc(config::DIRECT_IO_ALIGNMENT, capacity));
+                slot.capacity = capacity;
+            }
+
+            slot.requests.resize(count);
+            for (size_t j = 0; j < count; ++j) {
+                slot.requests[j] = {(uint64_t)candidates[j].id * stride, (uint32_t)stride, slot.buffer + j * stride};
+            }
+            ensure_open(slot).submit(slot.requests.data(), count);
+        }
+
+        // Exact distances over the landed vectors, best k
+        std::vector<Result> finish_rerank(IOSlot& slot, const float* query, std::vector<Result>& candidates, size_t count, int k) {
+            for (size_t j = 0; j < count; ++j) {
+                const float* exact = reinterpret_cast<const float*>(slot.buffer + j * header_.vector_stride);
+                candidates[j].distance = get_distance(query, exact, header_.dim);
+            }
+            candidates.resize(count);
+            std::sort(candidates.begin(), candidates.end());
+            if (candidates.size() > (size_t)k) candidates.resize(k);
+            return std::move(candidates);
+        }
+
+        void run_pipeline(IOSlot& slot, const float* queries, size_t begin, size_t end, int k,
+                          std::vector<std::vector<Result>>& results) {
+            const int ef = std::max(100, k);
+            std::vector<Result> pending;
+            size_t pending_index = 0;
+            size_t pending_count = 0;
+            bool has_pending = false;
+
+            for (size_t i = begin; i < end; ++i) {
+                // 1. Traverse query i while the reads of query i-1 are in flight
+                std::vector<Result> candidates = traverse(queries + i * header_.dim, ef);
+
+                // 2. Land and re-rank query i-1
+                if (has_pending) {
+                    slot.reader.wait_all();
+                    results[pending_index] = finish_rerank(slot, queries + pending_index * header_.dim, pending, pending_count, k);
+                }
+
+                // 3. Issue query i's reads
+                pending_count = std::min(candidates.size(), std::max((size_t)k, rerank_));
+                submit_rerank(slot, candidates, pending_count);
+                pending = std::move(candidates);
+                pending_index = i;
+                has_pending = true;
+            }
+
+            if (has_pending) {
+                slot.reader.wait_all();
+                results[pending_index] = finish_rerank(slot, queries + pending_index * header_.dim, pending, pending_count, k);
+            }
+        }
+    };
+
+} // namespace nanodb
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace nanodb {
+
+    namespace protocol {
+
+        // --- Wire Format ---
+        // Little-endian, fixed-size headers, no padding.
+        //
+        // Request:  RequestHeader + dim * float32
+        // Response: ResponseHeader + count * ResultEntry
+        //
+        // Clients may pipeline: responses carry the request_id and can arrive
+        // out of order, since queries from one connection may land in different batches.
+
+        constexpr uint32_t REQUEST_MAGIC = 0x51424E44;  // "DNBQ"
+        constexpr uint32_t RESPONSE_MAGIC = 0x52424E44; // "DNBR"
+
+        constexpr uint32_t MAX_K = 1024;
+
+        enum Op : uint16_t {
+            OP_SEARCH = 1,
+            OP_PING = 2,
+        };
+
+        enum Status : uint16_t {
+            STATUS_OK = 0,
+            STATUS_BAD_REQUEST = 1,
+            STATUS_BAD_DIMENSION = 2,
+        };
+
+#pragma pack(push, 1)
+        struct RequestHeader {
+            uint32_t magic;
+            uint16_t op;
+            uint16_t k;
+            uint32_t request_id;
+            uint32_t dim; // Number of float32 values that follow
+        };
+
+        struct ResponseHeader {
+            uint32_t magic;
+            uint16_t status;
+            uint16_t count; // Number of ResultEntry records that follow
+            uint32_t request_id;
+            uint32_t reserved;
+        };
+
+        struct ResultEntry {
+            uint32_t id;
+            float distance;
+        };
+#pragma pack(pop)
+
+        static_assert(sizeof(RequestHeader) == 16, "RequestHeader must be 16 bytes");
+        static_assert(sizeof(ResponseHeader) == 16, "ResponseHeader must be 16 bytes");
+        static_assert(sizeof(ResultEntry) == 8, "ResultEntry must be 8 bytes");
+
+    } // namespace protocol
+
+} // namespace nanodb
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace nanodb {
+
+    struct ReadRequest {
+        uint64_t offset; // File offset (DIRECT_IO_ALIGNMENT-aligned in direct mode)
+        uint32_t length; // Bytes to read (multiple of DIRECT_IO_ALIGNMENT in direct mode)
+        void* buffer;    // Destination (DIRECT_IO_ALIGNMENT-aligned in direct mode)
+    };
+
+    // Buffers for direct I/O (size must be a multiple of alignment).
+    // _aligned_malloc / _aligned_free on Windows, aligned_alloc / free elsewhere.
+    void* aligned_buffer_alloc(size_t alignment, size_t size);
+    void aligned_buffer_free(void* ptr);
+
+    // --- Async Reader ---
+    // Batched positional reads that bypass the page cache.
+    // Linux: O_DIRECT + io_uring (raw syscalls, no liburing). If the kernel refuses io_uring
+    // (or IORING_OP_READ, pre-5.6) or the filesystem refuses O_DIRECT, it degrades to
+    // buffered / synchronous pread.
+    // Not thread-safe: use one reader per thread.
+    class AsyncReader {
+    public:
+        AsyncReader();
+        ~AsyncReader();
+
+        AsyncReader(const AsyncReader&) = delete;
+        AsyncReader& operator=(const AsyncReader&) = delete;
+
+        // Open file read-only and set up a submission ring of `queue_depth` entries
+        void open_file(const std::string& filepath, bool direct, unsigned queue_depth);
+
+        void close_file();
+
+        // Queue reads and return immediately. Buffers must stay valid until wait_all().
+        // (Synchronous fallback: the reads complete before this returns.)
+        void submit(const ReadRequest* requests, size_t count);
+
+        // Block until every submitted read has completed. A failed read is reported only
+        // after the rest have landed, so the reader stays usable.
+        void wait_all();
+
+        bool is_direct() const;
+        bool is_async() const;
+
+    private:
+        struct Ring; // io_uring state, defined in the .cpp
+
+        std::string file_path_;
+        bool direct_;
+        std::unique_ptr<Ring> ring_;
+        std::vector<ReadRequest> in_flight_; // Indexed by completion user_data
+        std::vector<uint32_t> free_slots_;
+        std::vector<uint32_t> batch_slots_;  // Slots queued by the current submit() round
+
+        void read_sync(const ReadRequest& request);
+
+        // OS-Specific Handles
+#ifdef _WIN32
+        void* file_handle_;
+#else
+        int file_fd_;
+#endif
+    };
+
+} // namespace nanodb
@@ -26,6 +26,9 @@ namespace nanodb {
         // Get current file size
         size_t get_size() const;
 
+        // Path passed to open_file
+        const std::string& get_path() const;
+
     private:
         std::string file_path_;
         size_t file_size_;
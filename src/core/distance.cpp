@@ -34,4 +34,30 @@ namespace nanodb {
         return total_dist;
     }
 
+    float get_distance_sq8(const float* query, const uint8_t* code, const float* vmin, const float* vscale, size_t dim) {
+        __m256 sum = _mm256_setzero_ps();
+
+        size_t i = 0;
+        for (; i + 8 <= dim; i += 8) {
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(code + i)); // Load 8 codes
+            __m256 codes = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));            // Widen u8 -> f32
+            __m256 decoded = _mm256_fmadd_ps(codes, _mm256_loadu_ps(vscale + i), _mm256_loadu_ps(vmin + i));
+            __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(query + i), decoded);
+            sum = _mm256_fmadd_ps(diff, diff, sum);
+        }
+
+        float temp[8];
+        _mm256_storeu_ps(temp, sum);
+
+        float total_dist = 0.0f;
+        for (int k = 0; k < 8; ++k) total_dist += temp[k];
+
+        for (; i < dim; ++i) {
+            float d = query[i] - (vmin[i] + code[i] * vscale[i]);
+            total_dist += d * d;
+        }
+
+        return total_dist;
+    }
+
 } // namespace nanodb
\ No newline at end of file
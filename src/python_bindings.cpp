@@ -1,10 +1,50 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h> 
+#include <pybind11/numpy.h>
+#include <limits>
+#include <cstring>
 #include "../include/core/hnsw.hpp"
+#include "../include/core/sharded_index.hpp"
+#include "../include/core/ivf.hpp"
+#include "../include/core/tiered_index.hpp"
 
 namespace py = pybind11;
 using namespace nanodb;
 
+// float32 + C-contiguous only: combined with .noconvert() the buffer is read in place.
+using FloatArray = py::array_t<float, py::array::c_style>;
+using IdArray = py::array_t<id_t, py::array::c_style | py::array::forcecast>;
+
+namespace {
+
+    void check_vectors(const FloatArray& arr, py::ssize_t ndim, const char* name) {
+        if (arr.ndim() != ndim || arr.shape(ndim - 1) != (py::ssize_t)config::VECTOR_DIM) {
+            throw py::value_error(std::string(name) + " must have " + std::to_string(ndim) +
+                                  " dimension(s) with a last axis of " + std::to_string(config::VECTOR_DIM));
+        }
+    }
+
+    // Packs per-query results into (ids, distances) of shape (n, k).
+    // Missing slots hold id 0xFFFFFFFF and distance +inf.
+    py::tuple to_arrays(const std::vector<std::vector<Result>>& results, py::ssize_t k) {
+        py::ssize_t n = (py::ssize_t)results.size();
+        IdArray ids({n, k});
+        py::array_t<float> distances({n, k});
+        auto id_view = ids.mutable_unchecked<2>();
+        auto dist_view = distances.mutable_unchecked<2>();
+
+        for (py::ssize_t i = 0; i < n; ++i) {
+            for (py::ssize_t j = 0; j < k; ++j) {
+                bool present = j < (py::ssize_t)results[i].size();
+                id_view(i, j) = present ? results[i][j].id : std::numeric_limits<id_t>::max();
+                dist_view(i, j) = present ? results[i][j].distance : std::numeric_limits<float>::infinity();
+            }
+        }
+        return py::make_tuple(ids, distances);
+    }
+
+} // namespace
+
 PYBIND11_MODULE(nanodb, m) {
     m.doc() = "NanoDB: High-Performance Vector Search Engine (C++ Backend)";
 
@@ -17,23 +57,223 @@ PYBIND11_MODULE(nanodb, m) {
         .def_readonly("id", &Result::id)
         .def_readonly("distance", &Result::distance)
         .def_readwrite("metadata", &Result::metadata) // <--- Bind metadata field
+        .def_readonly("early_terminated", &Result::early_terminated)
         .def("__repr__", [](const Result &r) {
             return "<Result id=" + std::to_string(r.id) + 
                    " dist=" + std::to_string(r.distance) + 
                    " meta='" + r.metadata + "'>";
         });
 
+    py::class_<SearchParams>(m, "SearchParams")
+        .def(py::init<>())
+        .def_readwrite("ef", &SearchParams::ef)
+        .def_readwrite("patience", &SearchParams::patience)
+        .def_readwrite("max_distance_computations", &SearchParams::max_distance_computations)
+        .def_readwrite("timeout_us", &SearchParams::timeout_us);
+
+    py::class_<WorkCounters>(m, "WorkCounters")
+        .def_readonly("distance_computations", &WorkCounters::distance_computations)
+        .def_readonly("hops", &WorkCounters::hops)
+        .def_readonly("visited_nodes", &WorkCounters::visited_nodes)
+        .def_readonly("heap_operations", &WorkCounters::heap_operations)
+        .def_readonly("lock_spins", &WorkCounters::lock_spins)
+        .def_readonly("search_layer_calls", &WorkCounters::search_layer_calls);
+
+    py::class_<HistogramSnapshot>(m, "HistogramSnapshot")
+        .def_readonly("buckets", &HistogramSnapshot::buckets)
+        .def_readonly("count", &HistogramSnapshot::count)
+        .def_readonly("total_ns", &HistogramSnapshot::total_ns)
+        .def("mean_us", &HistogramSnapshot::mean_us)
+        .def("percentile_us", &HistogramSnapshot::percentile_us, py::arg("p"));
+
+    py::class_<StatsSnapshot>(m, "Stats")
+        .def_readonly("enabled", &StatsSnapshot::enabled)
+        .def_readonly("searches", &StatsSnapshot::searches)
+        .def_readonly("inserts", &StatsSnapshot::inserts)
+        .def_readonly("mmap_resizes", &StatsSnapshot::mmap_resizes)
+        .def_readonly("metadata_reads", &StatsSnapshot::metadata_reads)
+        .def_readonly("search_work", &StatsSnapshot::search_work)
+        .def_readonly("insert_work", &StatsSnapshot::insert_work)
+        .def_readonly("search_latency", &StatsSnapshot::search_latency)
+        .def_readonly("insert_latency", &StatsSnapshot::insert_latency)
+        .def_readonly("metadata_read_latency", &StatsSnapshot::metadata_read_latency);
+
     py::class_<HNSW>(m, "HNSW")
         // Init now takes optional metadata path
         .def(py::init<MMapHandler&, std::string>(), py::arg("storage"), py::arg("meta_path") = "data/metadata.bin")
         
         // Insert now takes optional metadata string
-        .def("insert", &HNSW::insert, "Insert a vector with ID",
+        .def("insert", py::overload_cast<const std::vector<float>&, id_t, const std::string&>(&HNSW::insert), "Insert a vector with ID",
              py::arg("vector"), py::arg("id"), py::arg("metadata") = "", 
              py::call_guard<py::gil_scoped_release>())
         
-        .def("search", &HNSW::search, "Search for k-nearest neighbors",
+        .def("search", py::overload_cast<const std::vector<float>&, int>(&HNSW::search), "Search for k-nearest neighbors",
              py::arg("query"), py::arg("k") = 5)
+
+        .def("search", py::overload_cast<const std::vector<float>&, int, const SearchParams&>(&HNSW::search),
+             "Search with adaptive early termination (see SearchParams)",
+             py::arg("query"), py::arg("k"), py::arg("params"),
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("search_batch", py::overload_cast<const std::vector<std::vector<float>>&, int>(&HNSW::search_batch),
+             "Search many queries in parallel",
+             py::arg("queries"), py::arg("k") = 5,
+             py::call_guard<py::gil_scoped_release>())
              
-        .def("get_metadata", &HNSW::get_metadata);
+        .def("range_search", py::overload_cast<const std::vector<float>&, float, size_t>(&HNSW::range_search),
+             "All neighbors within a squared-L2 radius, closest first",
+             py::arg("query"), py::arg("radius"), py::arg("max_results") = 1000,
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("range_search_batch", &HNSW::range_search_batch, "Range search many queries in parallel",
+             py::arg("queries"), py::arg("radius"), py::arg("max_results") = 1000,
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("merge", &HNSW::merge, "Append another index and cross-link the graphs; returns the id offset",
+             py::arg("other"),
+             py::call_guard<py::gil_scoped_release>())
+
+        // --- NumPy (Buffer Protocol) ---
+        .def("insert_numpy", [](HNSW& self, FloatArray vector, id_t id, const std::string& metadata) {
+                check_vectors(vector, 1, "vector");
+                const float* data = vector.data();
+                py::gil_scoped_release release;
+                self.insert(data, config::VECTOR_DIM, id, metadata);
+             }, "Insert a float32 NumPy vector without copying it",
+             py::arg("vector").noconvert(), py::arg("id"), py::arg("metadata") = "")
+
+        .def("insert_batch_numpy", [](HNSW& self, FloatArray vectors, IdArray ids) {
+                check_vectors(vectors, 2, "vectors");
+                if (ids.ndim() != 1 || ids.shape(0) != vectors.shape(0)) throw py::value_error("ids must hold one id per row");
+                const float* data = vectors.data();
+                const id_t* id_data = ids.data();
+                size_t n = (size_t)vectors.shape(0);
+                py::gil_scoped_release release;
+                for (size_t i = 0; i < n; ++i) self.insert(data + i * config::VECTOR_DIM, config::VECTOR_DIM, id_data[i]);
+             }, "Insert an (n, dim) float32 array row by row, reading it in place",
+             py::arg("vectors").noconvert(), py::arg("ids"))
+
+        .def("search_numpy", [](HNSW& self, FloatArray query, int k) {
+                check_vectors(query, 1, "query");
+                const float* data = query.data();
+                std::vector<std::vector<Result>> results(1);
+                {
+                    py::gil_scoped_release release;
+                    results[0] = self.search(data, k, false);
+                }
+                py::tuple packed = to_arrays(results, (py::ssize_t)results[0].size());
+                return py::make_tuple(packed[0].attr("reshape")(-1), packed[1].attr("reshape")(-1));
+             }, "Search with a float32 NumPy query; returns (ids, distances) arrays",
+             py::arg("query").noconvert(), py::arg("k") = 5)
+
+        .def("search_batch_numpy", [](HNSW& self, FloatArray queries, int k) {
+                check_vectors(queries, 2, "queries");
+                const float* data = queries.data();
+                size_t n = (size_t)queries.shape(0);
+                std::vector<std::vector<Result>> results;
+                {
+                    py::gil_scoped_release release;
+                    results = self.search_batch(data, n, k, false);
+                }
+                return to_arrays(results, std::max(k, 0));
+             }, "Search an (n, dim) float32 array; returns (ids, distances) of shape (n, k)",
+             py::arg("queries").noconvert(), py::arg("k") = 5)
+
+        // ids=None, copy=True (default): every stored row, copied out of the mmap file.
+        // ids=None, copy=False: UNSAFE read-only strided view straight over the mapping. The
+        //   HNSW object is kept alive, but the mapping is not: any insert / merge that grows the
+        //   file, or MMapHandler.close_file(), unmaps it and reading the view then crashes.
+        // ids given: gathers the requested rows into a new array (copy is ignored).
+        .def("get_vectors", [](py::handle self_handle, py::object ids, bool copy) -> py::array {
+                HNSW& self = self_handle.cast<HNSW&>();
+                const size_t n = self.size();
+
+                if (ids.is_none()) {
+                    if (n == 0) return FloatArray({(py::ssize_t)0, (py::ssize_t)config::VECTOR_DIM});
+                    py::array view(py::dtype::of<float>(),
+                                   {(py::ssize_t)n, (py::ssize_t)config::VECTOR_DIM},
+                                   {(py::ssize_t)sizeof(Node), (py::ssize_t)sizeof(float)},
+                                   self.get_vector(0), self_handle); // Keeps the index alive
+                    if (copy) return view.attr("copy")().cast<py::array>(); // Packs the strided rows into a new C-order array
+                    view.attr("setflags")(py::arg("write") = false);
+                    return view;
+                }
+
+                IdArray id_arr = IdArray::ensure(ids);
+                if (!id_arr || id_arr.ndim() != 1) throw py::value_error("ids must be a 1-D sequence of integers");
+
+                py::ssize_t m = id_arr.shape(0);
+                FloatArray out({m, (py::ssize_t)config::VECTOR_DIM});
+                float* dst = out.mutable_data();
+                for (py::ssize_t i = 0; i < m; ++i) {
+                    id_t id = id_arr.at(i);
+                    if (id >= n) throw py::index_error("id " + std::to_string(id) + " is out of range");
+                    std::memcpy(dst + i * config::VECTOR_DIM, self.get_vector(id), config::VECTOR_DIM * sizeof(float));
+                }
+                return out;
+             }, "Stored vectors as a NumPy copy (all rows or selected ids). copy=False returns an unsafe "
+                "zero-copy view of all rows that must not be read after the index grows or its storage is closed",
+             py::arg("ids") = py::none(), py::arg("copy") = true)
+
+        .def("get_metadata", &HNSW::get_metadata)
+        .def("size", &HNSW::size)
+
+        .def("stats", &HNSW::stats, "Snapshot of hot-path counters and latency histograms")
+        .def("set_stats_enabled", &HNSW::set_stats_enabled, py::arg("enabled"))
+        .def("reset_stats", &HNSW::reset_stats);
+
+    py::class_<ShardedIndex>(m, "ShardedIndex")
+        .def(py::init<std::string, size_t, size_t>(), py::arg("directory"), py::arg("num_shards"),
+             py::arg("initial_shard_size") = 10 * 1024 * 1024)
+
+        .def("insert", &ShardedIndex::insert, "Insert a vector into the shard owning its ID",
+             py::arg("vector"), py::arg("id"), py::arg("metadata") = "",
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("insert_batch", &ShardedIndex::insert_batch, "Insert many vectors, filling shards in parallel",
+             py::arg("vectors"), py::arg("ids"), py::arg("metadata") = std::vector<std::string>{},
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("search", &ShardedIndex::search, "Fan out to all shards and merge the top-k",
+             py::arg("query"), py::arg("k") = 5,
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("clear_shard", &ShardedIndex::clear_shard, "Delete a shard's files so it can be rebuilt")
+        .def("num_shards", &ShardedIndex::num_shards)
+        .def("shard_of", &ShardedIndex::shard_of);
+
+    py::class_<IVFIndex>(m, "IVFIndex")
+        .def(py::init<MMapHandler&, size_t>(), py::arg("storage"), py::arg("nlist") = config::IVF_NLIST)
+
+        .def("build", py::overload_cast<const std::vector<std::vector<float>>&, const std::vector<id_t>&>(&IVFIndex::build),
+             "Train k-means centroids and bulk-load all vectors",
+             py::arg("vectors"), py::arg("ids"),
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("search", py::overload_cast<const std::vector<float>&, int, int>(&IVFIndex::search), "Scan the nprobe closest lists for k-nearest neighbors",
+             py::arg("query"), py::arg("k") = 5, py::arg("nprobe") = config::IVF_NPROBE)
+
+        .def("size", &IVFIndex::size)
+        .def("num_lists", &IVFIndex::num_lists);
+
+    py::class_<TieredIndex>(m, "TieredIndex")
+        .def(py::init<std::string, size_t, bool>(), py::arg("prefix"),
+             py::arg("rerank") = config::TIERED_RERANK, py::arg("direct_io") = true)
+
+        .def_static("build", &TieredIndex::build, "Export an HNSW index to <prefix>.graph + <prefix>.vec",
+                    py::arg("source"), py::arg("prefix"),
+                    py::call_guard<py::gil_scoped_release>())
+
+        .def("search", &TieredIndex::search, "Traverse in RAM, re-rank with exact vectors read from disk",
+             py::arg("query"), py::arg("k") = 5,
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("search_batch", py::overload_cast<const std::vector<std::vector<float>>&, int>(&TieredIndex::search_batch),
+             "Pipelined batch search (disk reads overlap the next traversal)",
+             py::arg("queries"), py::arg("k") = 5,
+             py::call_guard<py::gil_scoped_release>())
+
+        .def("size", &TieredIndex::size)
+        .def("is_direct", &TieredIndex::is_direct)
+        .def("is_async", &TieredIndex::is_async);
 }
\ No newline at end of file
@@ -0,0 +1,470 @@
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <condition_variable>
+
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "../include/common/config.hpp"
+#include "../include/storage/mmap_handler.hpp"
+#include "../include/core/hnsw.hpp"
+#include "../include/server/protocol.hpp"
+
+using namespace nanodb;
+using namespace std;
+
+// --- Server Settings ---
+struct ServerOptions {
+    string db_path = "data/index.ndb";
+    string meta_path = "data/metadata.bin";
+    string socket_path = "/tmp/nanodb.sock";
+    size_t max_batch = 64;      // Upper bound on queries per micro-batch
+    int max_wait_us = 200;      // Longest a batch may wait for stragglers under load
+    int threads = 0;            // OpenMP workers for batch search (0 = OpenMP default)
+    size_t max_queue = 4096;    // Queries waiting for the batcher before reads pause
+};
+
+// Per-connection limits: past any of these the event loop stops reading from the client
+// until the batcher catches up or the client drains its responses.
+constexpr size_t MAX_PENDING_PER_CONN = 256;      // Queries queued or in flight
+constexpr size_t MAX_OUTBUF_BYTES = 4 * 1024 * 1024; // Responses not yet accepted by the socket
+constexpr size_t READ_CHUNK = 64 * 1024;          // One read per wakeup, so no client monopolizes the loop
+
+static atomic<bool> g_running{true};
+
+static void handle_signal(int) { g_running = false; }
+
+// --- Connection ---
+// Owned by the event loop, which does all socket I/O. The batcher only appends to
+// outbuf and hands the connection back through the ReadyList. The fd closes when the
+// last owner drops it, so a batch in flight never touches a reused fd.
+struct Connection {
+    int fd;
+    vector<char> inbuf;          // Event loop only
+    uint32_t interest = 0;       // Registered epoll events (event loop only)
+
+    mutex out_lock;              // Guards outbuf / out_pos
+    vector<char> outbuf;
+    size_t out_pos = 0;          // Bytes of outbuf already sent
+
+    atomic<size_t> pending{0};   // Queries handed to the batcher and not yet answered
+    atomic<bool> alive{true};
+
+    explicit Connection(int f) : fd(f) {}
+    ~Connection() { close(fd); }
+
+    size_t out_bytes() {
+        lock_guard<mutex> lock(out_lock);
+        return outbuf.size() - out_pos;
+    }
+
+    // Non-blocking: sends what the socket accepts now. Returns false if the peer is gone.
+    bool flush() {
+        lock_guard<mutex> lock(out_lock);
+        while (out_pos < outbuf.size()) {
+            ssize_t n = send(fd, outbuf.data() + out_pos, outbuf.size() - out_pos, MSG_NOSIGNAL);
+            if (n > 0) { out_pos += n; continue; }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        if (out_pos == outbuf.size()) { outbuf.clear(); out_pos = 0; }
+        else if (out_pos > outbuf.size() / 2) { outbuf.erase(outbuf.begin(), outbuf.begin() + out_pos); out_pos = 0; }
+        return true;
+    }
+};
+
+struct PendingQuery {
+    shared_ptr<Connection> conn;
+    uint32_t request_id;
+    uint16_t k;
+    vector<float> query;
+};
+
+// --- Batch Queue ---
+// The event loop pushes single queries; the batcher drains them in micro-batches.
+class BatchQueue {
+public:
+    void push(PendingQuery&& q) {
+        {
+            lock_guard<mutex> lock(mutex_);
+            queue_.push_back(move(q));
+        }
+        cv_.notify_one();
+    }
+
+    size_t size() {
+        lock_guard<mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    // Adaptive window: when idle, a lone query runs immediately. When the previous
+    // batch had company (i.e. we are under load), wait up to max_wait for the batch to fill.
+    vector<PendingQuery> pop_batch(size_t max_batch, chrono::microseconds max_wait, bool under_load) {
+        unique_lock<mutex> lock(mutex_);
+        cv_.wait_for(lock, chrono::milliseconds(100), [&] { return !queue_.empty() || !g_running; });
+
+        if (under_load && queue_.size() < max_batch) {
+            cv_.wait_for(lock, max_wait, [&] { return queue_.size() >= max_batch || !g_running; });
+        }
+
+        vector<PendingQuery> batch;
+        while (!queue_.empty() && batch.size() < max_batch) {
+            batch.push_back(move(queue_.front()));
+            queue_.pop_front();
+        }
+        return batch;
+    }
+
+    void wake_all() { cv_.notify_all(); }
+
+private:
+    mutex mutex_;
+    condition_variable cv_;
+    deque<PendingQuery> queue_;
+};
+
+// --- Ready List ---
+// Batcher -> event loop handoff: connections with fresh output, signalled through an eventfd.
+class ReadyList {
+public:
+    ReadyList() : efd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+        if (efd_ < 0) throw runtime_error("eventfd() failed");
+    }
+    ~ReadyList() { close(efd_); }
+
+    void post(vector<shared_ptr<Connection>>&& conns) {
+        {
+            lock_guard<mutex> lock(mutex_);
+            for (auto& c : conns) ready_.push_back(move(c));
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(efd_, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    vector<shared_ptr<Connection>> take() {
+        uint64_t count;
+        while (read(efd_, &count, sizeof(count)) > 0) {}
+        lock_guard<mutex> lock(mutex_);
+        vector<shared_ptr<Connection>> out;
+        out.swap(ready_);
+        return out;
+    }
+
+    int fd() const { return efd_; }
+
+private:
+    int efd_;
+    mutex mutex_;
+    vector<shared_ptr<Connection>> ready_;
+};
+
+// Appends one response frame to the connection's output buffer (sent by the event loop).
+static void queue_response(Connection& conn, uint32_t request_id, uint16_t status, const vector<Result>& results) {
+    protocol::ResponseHeader h = {protocol::RESPONSE_MAGIC, status, (uint16_t)results.size(), request_id, 0};
+
+    lock_guard<mutex> lock(conn.out_lock);
+    size_t at = conn.outbuf.size();
+    conn.outbuf.resize(at + sizeof(h) + results.size() * sizeof(protocol::ResultEntry));
+    char* cursor = conn.outbuf.data() + at;
+    memcpy(cursor, &h, sizeof(h));
+    cursor += sizeof(h);
+    for (const Result& r : results) {
+        protocol::ResultEntry e = {r.id, r.distance};
+        memcpy(cursor, &e, sizeof(e));
+        cursor += sizeof(e);
+    }
+}
+
+// --- Batcher ---
+// Packs a micro-batch into one contiguous query block and runs it through
+// HNSW::search_batch, which spreads the batch across the OpenMP worker pool.
+static void batch_loop(HNSW& index, BatchQueue& queue, ReadyList& ready, const ServerOptions& opts) {
+    // omp_set_num_threads is per calling thread: set it here, where the parallel regions start
+    if (opts.threads > 0) omp_set_num_threads(opts.threads);
+
+    vector<float> block;
+    bool under_load = false;
+
+    while (g_running) {
+        vector<PendingQuery> batch = queue.pop_batch(opts.max_batch, chrono::microseconds(opts.max_wait_us), under_load);
+        if (batch.empty()) { under_load = false; continue; }
+        under_load = batch.size() > 1;
+
+        int max_k = 1;
+        block.resize(batch.size() * config::VECTOR_DIM);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            memcpy(&block[i * config::VECTOR_DIM], batch[i].query.data(), config::VECTOR_DIM * sizeof(float));
+            max_k = max(max_k, (int)batch[i].k);
+        }
+
+        // Metadata stays on disk: the wire format is ids + distances only
+        vector<vector<Result>> results = index.search_batch(block.data(), batch.size(), max_k, false);
+
+        vector<shared_ptr<Connection>> touched;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            Connection& conn = *batch[i].conn;
+            if (results[i].size() > batch[i].k) results[i].resize(batch[i].k);
+            if (conn.alive) queue_response(conn, batch[i].request_id, protocol::STATUS_OK, results[i]);
+            conn.pending--;
+            if (touched.empty() || touched.back() != batch[i].conn) touched.push_back(batch[i].conn);
+        }
+        ready.post(move(touched));
+    }
+}
+
+// Parses complete frames from the connection buffer until it runs dry or the connection
+// hits a limit (the rest stays buffered). Returns false on a protocol error.
+static bool drain_frames(const shared_ptr<Connection>& conn, BatchQueue& queue, const ServerOptions& opts) {
+    vector<char>& buf = conn->inbuf;
+    size_t pos = 0;
+
+    while (buf.size() - pos >= sizeof(protocol::RequestHeader)) {
+        if (conn->pending >= MAX_PENDING_PER_CONN || queue.size() >= opts.max_queue
+            || conn->out_bytes() >= MAX_OUTBUF_BYTES) break; // Backpressure: leave it for later
+
+        protocol::RequestHeader h;
+        memcpy(&h, buf.data() + pos, sizeof(h));
+
+        if (h.magic != protocol::REQUEST_MAGIC || h.dim > 65536) return false;
+
+        size_t frame_size = sizeof(h) + (size_t)h.dim * sizeof(float);
+        if (buf.size() - pos < frame_size) break; // Wait for the rest
+
+        const char* payload = buf.data() + pos + sizeof(h);
+        pos += frame_size;
+
+        if (h.op == protocol::OP_PING) {
+            queue_response(*conn, h.request_id, protocol::STATUS_OK, {});
+        } else if (h.op != protocol::OP_SEARCH || h.k == 0 || h.k > protocol::MAX_K) {
+            queue_response(*conn, h.request_id, protocol::STATUS_BAD_REQUEST, {});
+        } else if (h.dim != config::VECTOR_DIM) {
+            queue_response(*conn, h.request_id, protocol::STATUS_BAD_DIMENSION, {});
+        } else {
+            PendingQuery q{conn, h.request_id, h.k, vector<float>(config::VECTOR_DIM)};
+            memcpy(q.query.data(), payload, config::VECTOR_DIM * sizeof(float));
+            conn->pending++;
+            queue.push(move(q));
+        }
+    }
+
+    buf.erase(buf.begin(), buf.begin() + pos);
+    return true;
+}
+
+// Reading stays off while the client has a full frame buffered that could not be
+// queued, or more than one maximal frame sitting in inbuf.
+static bool wants_input(const Connection& conn) {
+    constexpr size_t max_frame = sizeof(protocol::RequestHeader) + 65536 * sizeof(float);
+    if (conn.inbuf.size() >= max_frame) return false;
+    if (conn.inbuf.size() >= sizeof(protocol::RequestHeader)) {
+        protocol::RequestHeader h;
+        memcpy(&h, conn.inbuf.data(), sizeof(h));
+        if (conn.inbuf.size() >= sizeof(h) + (size_t)h.dim * sizeof(float)) return false; // Blocked on a limit
+    }
+    return true;
+}
+
+static int open_listener(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw runtime_error("socket() failed");
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) { close(fd); throw runtime_error("Socket path too long"); }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    unlink(path.c_str()); // Stale socket from a previous run
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) { close(fd); throw runtime_error("bind() failed on " + path); }
+    if (listen(fd, SOMAXCONN) != 0) { close(fd); throw runtime_error("listen() failed"); }
+    return fd;
+}
+
+// --- Event Loop ---
+// Single epoll thread: accepts clients, reads frames, hands queries to the batcher and
+// writes every response. A client that stops reading only fills its own outbuf; once
+// it crosses a limit its reads pause, and they resume when the backlog drains.
+static void event_loop(int listen_fd, BatchQueue& queue, ReadyList& ready, const ServerOptions& opts) {
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) { cerr << "Error: epoll_create1() failed" << endl; return; }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.fd = ready.fd();
+    epoll_ctl(epfd, EPOLL_CTL_ADD, ready.fd(), &ev);
+
+    unordered_map<int, shared_ptr<Connection>> connections;
+    vector<epoll_event> events(256);
+    vector<char> chunk(READ_CHUNK);
+
+    auto drop = [&](int fd) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+        auto it = connections.find(fd);
+        if (it != connections.end()) { it->second->alive = false; connections.erase(it); }
+    };
+
+    // Queue what is buffered, push out what is queued, then re-arm EPOLLIN / EPOLLOUT.
+    // Returns false if the connection had to be dropped.
+    auto service = [&](const shared_ptr<Connection>& conn) {
+        if (!drain_frames(conn, queue, opts) || !conn->flush()) { drop(conn->fd); return false; }
+
+        uint32_t interest = 0;
+        if (wants_input(*conn) && conn->out_bytes() < MAX_OUTBUF_BYTES) interest |= EPOLLIN;
+        if (conn->out_bytes() > 0) interest |= EPOLLOUT;
+
+        if (interest != conn->interest) {
+            epoll_event cev{};
+            cev.events = interest;
+            cev.data.fd = conn->fd;
+            epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &cev);
+            conn->interest = interest;
+        }
+        return true;
+    };
+
+    while (g_running) {
+        int n = epoll_wait(epfd, events.data(), (int)events.size(), 200);
+        if (n < 0 && errno != EINTR) break;
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == listen_fd) {
+                int client;
+                while ((client = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    auto conn = make_shared<Connection>(client);
+                    conn->interest = EPOLLIN;
+                    epoll_event cev{};
+                    cev.events = conn->interest;
+                    cev.data.fd = client;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, client, &cev);
+                    connections[client] = conn;
+                }
+                continue;
+            }
+
+            if (fd == ready.fd()) {
+                // Batch results landed: flush them, and give paused clients a chance to resume
+                for (auto& conn : ready.take()) {
+                    if (conn->alive) service(conn);
+                }
+                for (auto it = connections.begin(); it != connections.end();) {
+                    shared_ptr<Connection> conn = (it++)->second;
+                    if (!(conn->interest & EPOLLIN)) service(conn);
+                }
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            shared_ptr<Connection> conn = it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) { drop(fd); continue; }
+
+            if (events[i].events & EPOLLIN) {
+                ssize_t r;
+                do { r = read(fd, chunk.data(), chunk.size()); } while (r < 0 && errno == EINTR);
+                if (r > 0) conn->inbuf.insert(conn->inbuf.end(), chunk.data(), chunk.data() + r);
+                else if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) { drop(fd); continue; } // EOF or hard error
+            }
+
+            service(conn);
+        }
+    }
+
+    for (auto& [fd, conn] : connections) conn->alive = false;
+    close(epfd);
+}
+
+static void print_usage() {
+    cout << "Usage: nano_server [--index PATH] [--meta PATH] [--socket PATH]\n"
+         << "                   [--max-batch N] [--max-wait-us N] [--max-queue N] [--threads N]" << endl;
+}
+
+int main(int argc, char** argv) {
+    ServerOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto next = [&]() -> string {
+            if (i + 1 >= argc) { print_usage(); exit(1); }
+            return argv[++i];
+        };
+        if (arg == "--index") opts.db_path = next();
+        else if (arg == "--meta") opts.meta_path = next();
+        else if (arg == "--socket") opts.socket_path = next();
+        else if (arg == "--max-batch") opts.max_batch = max(1, stoi(next()));
+        else if (arg == "--max-wait-us") opts.max_wait_us = max(0, stoi(next()));
+        else if (arg == "--max-queue") opts.max_queue = max(1, stoi(next()));
+        else if (arg == "--threads") opts.threads = stoi(next());
+        else { print_usage(); return arg == "--help" ? 0 : 1; }
+    }
+
+    cout << "============================================" << endl;
+    cout << "   NanoDB: Query Server (Unix Socket)       " << endl;
+    cout << "============================================" << endl;
+
+    if (!filesystem::exists(opts.db_path)) {
+        cerr << "Error: index file not found: " << opts.db_path << endl;
+        return 1;
+    }
+
+    MMapHandler storage;
+    try {
+        storage.open_file(opts.db_path, 0); // Existing file: maps its current size
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    HNSW index(storage, opts.meta_path);
+
+    int listen_fd;
+    try {
+        listen_fd = open_listener(opts.socket_path);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    cout << "[Server] Listening on " << opts.socket_path
+         << " (max_batch=" << opts.max_batch << ", max_wait_us=" << opts.max_wait_us << ")" << endl;
+
+    BatchQueue queue;
+    ReadyList ready;
+    thread batcher(batch_loop, ref(index), ref(queue), ref(ready), cref(opts));
+
+    event_loop(listen_fd, queue, ready, opts);
+
+    g_running = false;
+    queue.wake_all();
+    batcher.join();
+
+    close(listen_fd);
+    unlink(opts.socket_path.c_str());
+    storage.close_file();
+    cout << "\n[System] Server stopped." << endl;
+
+    return 0;
+}
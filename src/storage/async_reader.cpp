@@ -0,0 +1,345 @@
+#include "../../include/storage/async_reader.hpp"
+#include "../../include/common/config.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+#include <algorithm>
+
+// OS-Specific Includes
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <sys/mman.h>
+    #if defined(__linux__) && __has_include(<linux/io_uring.h>)
+        #include <linux/io_uring.h>
+        #include <sys/syscall.h>
+        #define NANODB_HAS_IO_URING 1
+    #endif
+#endif
+
+namespace nanodb {
+
+#ifdef NANODB_HAS_IO_URING
+    // --- Minimal io_uring ---
+    // Just enough of the ring protocol for IORING_OP_READ: one SQ, one CQ, no SQPOLL.
+    struct AsyncReader::Ring {
+        int fd = -1;
+        unsigned entries = 0;
+        void* sq_ptr = nullptr;
+        void* cq_ptr = nullptr;
+        size_t sq_size = 0;
+        size_t cq_size = 0;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqes_size = 0;
+
+        unsigned* sq_tail = nullptr;
+        unsigned* sq_mask = nullptr;
+        unsigned* sq_array = nullptr;
+        unsigned* cq_head = nullptr;
+        unsigned* cq_tail = nullptr;
+        unsigned* cq_mask = nullptr;
+        io_uring_cqe* cqes = nullptr;
+
+        bool setup(unsigned depth) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+            if (fd < 0) return false; // ENOSYS / EPERM (seccomp): caller falls back to pread
+
+            entries = params.sq_entries;
+            sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap) sq_size = cq_size = std::max(sq_size, cq_size);
+
+            sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sq_ptr == MAP_FAILED) { sq_ptr = nullptr; teardown(); return false; }
+
+            if (single_mmap) {
+                cq_ptr = sq_ptr;
+            } else {
+                cq_ptr = mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cq_ptr == MAP_FAILED) { cq_ptr = nullptr; teardown(); return false; }
+            }
+
+            sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            void* s = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (s == MAP_FAILED) { teardown(); return false; }
+            sqes = static_cast<io_uring_sqe*>(s);
+
+            char* sq = static_cast<char*>(sq_ptr);
+            char* cq = static_cast<char*>(cq_ptr);
+            sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        void teardown() {
+            if (sqes) munmap(sqes, sqes_size);
+            if (cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+            if (sq_ptr) munmap(sq_ptr, sq_size);
+            if (fd >= 0) close(fd);
+            sqes = nullptr; sq_ptr = cq_ptr = nullptr; fd = -1;
+        }
+
+        ~Ring() { teardown(); }
+
+        // Write one SQE (kernel consumes it on the next enter())
+        void push(int file_fd, const ReadRequest& r, uint64_t user_data) {
+            unsigned tail = *sq_tail; // Only we write the tail
+            unsigned index = tail & *sq_mask;
+            io_uring_sqe* sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = file_fd;
+            sqe->addr = reinterpret_cast<uint64_t>(r.buffer);
+            sqe->len = r.length;
+            sqe->off = r.offset;
+            sqe->user_data = user_data;
+            sq_array[index] = index;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        int enter(unsigned to_submit, unsigned min_complete) {
+            unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+            int ret;
+            do {
+                ret = (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+            } while (ret < 0 && errno == EINTR);
+            return ret;
+        }
+    };
+#else
+    struct AsyncReader::Ring {
+        bool setup(unsigned) { return false; }
+    };
+#endif
+
+    void* aligned_buffer_alloc(size_t alignment, size_t size) {
+#ifdef _WIN32
+        void* ptr = _aligned_malloc(size, alignment);
+#else
+        void* ptr = std::aligned_alloc(alignment, size);
+#endif
+        if (!ptr) throw std::bad_alloc();
+        return ptr;
+    }
+
+    void aligned_buffer_free(void* ptr) {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+
+    AsyncReader::AsyncReader() : direct_(false) {
+#ifdef _WIN32
+        file_handle_ = INVALID_HANDLE_VALUE;
+#else
+        file_fd_ = -1;
+#endif
+    }
+
+    AsyncReader::~AsyncReader() {
+        close_file();
+    }
+
+    void AsyncReader::open_file(const std::string& filepath, bool direct, unsigned queue_depth) {
+        close_file();
+        file_path_ = filepath;
+        direct_ = false;
+
+#ifdef _WIN32
+        // --- Windows Implementation --- (Synchronous, unbuffered when requested)
+        DWORD flags = FILE_ATTRIBUTE_NORMAL | (direct ? FILE_FLAG_NO_BUFFERING : 0);
+        file_handle_ = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+        if (file_handle_ == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open file (Windows)");
+        direct_ = direct;
+        (void)queue_depth;
+#else
+        // Linux/POSIX Implementation
+#ifdef O_DIRECT
+        if (direct) {
+            file_fd_ = open(filepath.c_str(), O_RDONLY | O_DIRECT);
+            if (file_fd_ != -1) {
+                // Some filesystems (tmpfs) accept the flag but reject the reads: probe one block
+                void* probe = aligned_buffer_alloc(config::DIRECT_IO_ALIGNMENT, config::DIRECT_IO_ALIGNMENT);
+                ssize_t n = pread(file_fd_, probe, config::DIRECT_IO_ALIGNMENT, 0);
+                aligned_buffer_free(probe);
+                if (n < 0) { close(file_fd_); file_fd_ = -1; }
+                else direct_ = true;
+            }
+        }
+#endif
+        if (file_fd_ == -1) file_fd_ = open(filepath.c_str(), O_RDONLY);
+        if (file_fd_ == -1) throw std::runtime_error("Failed to open file (POSIX)");
+
+        ring_ = std::make_unique<Ring>();
+        if (!ring_->setup(queue_depth)) ring_.reset();
+
+        if (ring_) {
+            in_flight_.assign(queue_depth, ReadRequest{0, 0, nullptr});
+            free_slots_.clear();
+            for (uint32_t i = 0; i < queue_depth; ++i) free_slots_.push_back(queue_depth - 1 - i);
+        }
+#endif
+    }
+
+    void AsyncReader::close_file() {
+#ifdef _WIN32
+        if (file_handle_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_handle_);
+            file_handle_ = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (ring_) {
+            try { wait_all(); } catch (const std::exception&) {} // Buffers are being released anyway
+            ring_.reset();
+        }
+        if (file_fd_ != -1) {
+            close(file_fd_);
+            file_fd_ = -1;
+        }
+#endif
+    }
+
+    void AsyncReader::read_sync(const ReadRequest& request) {
+        char* dst = static_cast<char*>(request.buffer);
+        uint64_t offset = request.offset;
+        size_t remaining = request.length;
+
+        while (remaining > 0) {
+#ifdef _WIN32
+            OVERLAPPED ov = {};
+            ov.Offset = (DWORD)(offset & 0xFFFFFFFF);
+            ov.OffsetHigh = (DWORD)(offset >> 32);
+            DWORD n = 0;
+            if (!ReadFile(file_handle_, dst, (DWORD)remaining, &n, &ov)) throw std::runtime_error("ReadFile failed");
+#else
+            ssize_t n = pread(file_fd_, dst, remaining, (off_t)offset);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) throw std::runtime_error("pread failed");
+#endif
+            if (n == 0) { std::memset(dst, 0, remaining); break; } // Past EOF
+            dst += n;
+            offset += n;
+            remaining -= n;
+        }
+    }
+
+    void AsyncReader::submit(const ReadRequest* requests, size_t count) {
+        size_t i = 0;
+#ifdef NANODB_HAS_IO_URING
+        while (ring_ && i < count) {
+            // Ring full: drain before queueing more (may also drop the ring, see wait_all)
+            if (free_slots_.empty()) { wait_all(); continue; }
+
+            const size_t first = i;
+            batch_slots_.clear();
+            while (i < count && !free_slots_.empty()) {
+                uint32_t slot = free_slots_.back();
+                free_slots_.pop_back();
+                in_flight_[slot] = requests[i];
+                ring_->push(file_fd_, requests[i], slot);
+                batch_slots_.push_back(slot);
+                i++;
+            }
+
+            // The kernel may take fewer SQEs than offered: keep entering until all are in
+            const unsigned queued = (unsigned)batch_slots_.size();
+            unsigned submitted = 0;
+            while (submitted < queued) {
+                int ret = ring_->enter(queued - submitted, 0);
+                if (ret > 0) { submitted += ret; continue; }
+
+                // EAGAIN / EBUSY: out of kernel resources, retry once a completion lands
+                size_t outstanding = in_flight_.size() - free_slots_.size() - (queued - submitted);
+                if (ret < 0 && (errno == EAGAIN || errno == EBUSY) && outstanding > 0) {
+                    ring_->enter(0, 1);
+                    continue;
+                }
+                break;
+            }
+
+            if (submitted < queued) {
+                // The ring refused the rest: release their slots, let the submitted reads
+                // land, then drop the ring. Reads from here on (these included) use pread.
+                for (unsigned j = submitted; j < queued; ++j) free_slots_.push_back(batch_slots_[j]);
+                i = first + submitted;
+                try { wait_all(); } catch (...) { ring_.reset(); throw; } // Unsent SQEs must never run later
+                ring_.reset();
+            }
+        }
+#endif
+        for (; i < count; ++i) read_sync(requests[i]);
+    }
+
+    void AsyncReader::wait_all() {
+#ifdef NANODB_HAS_IO_URING
+        if (!ring_) return;
+
+        std::string error;
+        bool unsupported = false;
+
+        while (free_slots_.size() < in_flight_.size()) {
+            unsigned head = *ring_->cq_head;
+            unsigned tail = __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE);
+
+            if (head == tail) {
+                if (ring_->enter(0, 1) < 0) throw std::runtime_error("io_uring_enter (wait) failed");
+                continue;
+            }
+
+            for (; head != tail; ++head) {
+                // Consume the CQE and its slot first, so a failure below never leaves them claimed
+                const io_uring_cqe& cqe = ring_->cqes[head & *ring_->cq_mask];
+                int res = cqe.res;
+                uint32_t slot = (uint32_t)cqe.user_data;
+                ReadRequest r = in_flight_[slot];
+                __atomic_store_n(ring_->cq_head, head + 1, __ATOMIC_RELEASE);
+                free_slots_.push_back(slot);
+
+                try {
+                    if (res == -EINVAL || res == -EOPNOTSUPP) {
+                        // Kernel has the ring but not IORING_OP_READ (5.1 - 5.5) if pread
+                        // accepts the same request; otherwise the request itself is bad
+                        read_sync(r);
+                        unsupported = true;
+                    } else if (res < 0) {
+                        if (error.empty()) error = "Async read failed: " + std::string(std::strerror(-res));
+                    } else if ((uint32_t)res < r.length) {
+                        // Short read: finish the tail synchronously
+                        ReadRequest rest = {r.offset + res, r.length - (uint32_t)res, static_cast<char*>(r.buffer) + res};
+                        read_sync(rest);
+                    }
+                } catch (const std::exception& e) {
+                    if (error.empty()) error = e.what();
+                }
+            }
+        }
+
+        if (unsupported) ring_.reset(); // Everything has landed: safe to fall back to pread
+        if (!error.empty()) throw std::runtime_error(error);
+#endif
+    }
+
+    bool AsyncReader::is_direct() const {
+        return direct_;
+    }
+
+    bool AsyncReader::is_async() const {
+        return ring_ != nullptr;
+    }
+
+} // namespace nanodb
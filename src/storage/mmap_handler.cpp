@@ -114,4 +114,8 @@ namespace nanodb {
         return file_size_;
     }
 
+    const std::string& MMapHandler::get_path() const {
+        return file_path_;
+    }
+
 } // namespace nanodb
\ No newline at end of file